@@ -31,6 +31,7 @@
 #include <sstream>
 
 #include <cmath>
+#include <csignal>
 #include <cstring>
 #include <utility>
 
@@ -49,6 +50,19 @@ struct write_parameters
     {}
 };
 
+//
+// SIGINT and SIGTERM ask the solver to stop (see @c baryonyx::context::stop)
+// so the best solution found so far is still written into the solution file.
+//
+baryonyx::context* stop_context = nullptr;
+
+extern "C" void
+stop_handler(int /*signum*/)
+{
+    if (stop_context)
+        stop_context->stop();
+}
+
 } // anonymous namespace
 
 static const char* file_format_error_format(
@@ -71,7 +85,20 @@ main(int argc, char* argv[])
     if (i < 0)
         return EXIT_FAILURE;
 
-    for (; i < argc; ++i) {
+    stop_context = ctx.get();
+    std::signal(SIGINT, stop_handler);
+    std::signal(SIGTERM, stop_handler);
+
+    ctx->set_progress_callback([](const baryonyx::progress& p) {
+        fmt::print("progress: value {} remaining constraints {} at {}s "
+                   "(thread: {})\n",
+                   p.value,
+                   p.remaining_constraints,
+                   p.duration,
+                   p.thread);
+    });
+
+    for (; i < argc and not ctx->stopped(); ++i) {
         try {
             auto pb = baryonyx::make_problem(ctx, argv[i]);
 
@@ -84,17 +111,42 @@ main(int argc, char* argv[])
                 auto filename =
                   ctx->get_string_parameter("check-filename", std::string());
 
-                auto result = baryonyx::make_result(ctx, filename);
-                if (result) {
-                    auto valid = baryonyx::is_valid_solution(pb, result);
-                    fmt::print("Check {} with {}: {}",
-                               argv[i],
-                               filename,
-                               (valid ? "success" : "failure"));
+                auto report = baryonyx::check_solution(ctx, pb, filename);
+                fmt::print("Check {} with {}: {} (value: {})\n",
+                           argv[i],
+                           filename,
+                           (report.valid ? "success" : "failure"),
+                           report.value);
+
+                if (report.unknown_variables > 0)
+                    fmt::print("  {} unknown variable(s)\n",
+                               report.unknown_variables);
+
+                if (not report.valid) {
+                    const auto& violated = report.violated_constraints;
+                    fmt::print("  {} violated constraint(s):", violated.size());
+
+                    for (std::size_t j = 0, e = std::min(violated.size(),
+                                                         std::size_t(10));
+                         j != e;
+                         ++j)
+                        fmt::print(" {}", violated[j]);
+
+                    fmt::print("{}\n", violated.size() > 10 ? " ..." : "");
                 }
             }
 
-            std::ofstream ofs(filename);
+            const auto format = baryonyx::get_result_format(ctx);
+            const bool sparse = baryonyx::get_result_sparse(ctx);
+
+            std::ofstream ofs(filename, std::ios::binary);
+
+            if (format == baryonyx::result_format::binary) {
+                auto ret = solve_or_optimize(ctx, pb);
+                baryonyx::write_result(ofs, ret, format, sparse);
+                continue;
+            }
+
             ofs << std::boolalpha
                 << std::setprecision(std::floor(
                      std::numeric_limits<double>::digits * std::log10(2) + 2));
@@ -115,7 +167,8 @@ main(int argc, char* argv[])
                 << '\n';
 
             if (ret.status == baryonyx::result_status::success) {
-                ofs << R"(\ Solution found: )" << ret.value << '\n' << ret;
+                ofs << R"(\ Solution found: )" << ret.value << '\n';
+                baryonyx::write_result(ofs, ret, format, sparse);
             } else {
                 ofs << R"(\ Solution not found. Missing constraints: )"
                     << ret.remaining_constraints << '\n';
@@ -167,7 +220,7 @@ file_format_error_format(baryonyx::file_format_error_tag failure) noexcept
         "bad constraint"
     };
 
-    return tag[static_cast<int>(failure)];
+    return tag[static_cast<int>(failure) - 1];
 }
 
 static const char*
@@ -182,7 +235,7 @@ problem_definition_error_format(
         "multiple constraints with different value"
     };
 
-    return tag[static_cast<int>(failure)];
+    return tag[static_cast<int>(failure) - 1];
 }
 
 static const char*
@@ -192,7 +245,7 @@ solver_error_format(baryonyx::solver_error_tag failure) noexcept
                                        "unrealisable constraint",
                                        "not enough memory" };
 
-    return tag[static_cast<int>(failure)];
+    return tag[static_cast<int>(failure) - 1];
 }
 
 static std::ostream&
@@ -0,0 +1,263 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "async-logger.hpp"
+
+#include <chrono>
+#include <utility>
+
+namespace bx = baryonyx;
+
+namespace {
+
+// Number of messages of a ring buffer, must be a power of two.
+constexpr std::size_t ring_capacity = 1024;
+
+// Without notification, the writer thread checks the rings at this period.
+constexpr std::chrono::milliseconds writer_period{ 10 };
+
+std::atomic<std::uint64_t> next_logger_id{ 1 };
+
+} // anonymous namespace
+
+struct bx::async_logger::ring
+{
+    struct entry
+    {
+        context::message_type type = context::message_type::info;
+        std::string msg;
+    };
+
+    ring()
+      : entries(ring_capacity)
+    {}
+
+    std::vector<entry> entries;
+
+    // The producer stores @c head and the writer thread stores @c tail, the
+    // padding keeps them on different cache lines.
+    std::atomic<std::size_t> head{ 0 };
+    char padding[64];
+    std::atomic<std::size_t> tail{ 0 };
+    std::atomic<bool> owned{ true };
+};
+
+namespace {
+
+//
+// The ring of the current thread. The ring is released at thread exit or
+// when the thread logs into another @c async_logger.
+//
+struct local_ring_handle
+{
+    std::shared_ptr<bx::async_logger::ring> ring;
+    std::uint64_t id = 0;
+
+    ~local_ring_handle() noexcept
+    {
+        release();
+    }
+
+    void release() noexcept
+    {
+        if (ring) {
+            ring->owned.store(false, std::memory_order_release);
+            ring.reset();
+        }
+
+        id = 0;
+    }
+};
+
+thread_local local_ring_handle local_handle;
+
+} // anonymous namespace
+
+namespace baryonyx {
+
+async_logger::async_logger(FILE* file,
+                           context::string_logger_functor string_logger)
+  : m_string_logger(std::move(string_logger))
+  , m_file(file)
+  , m_id(next_logger_id.fetch_add(1, std::memory_order_relaxed))
+  , m_writer(&async_logger::run, this)
+{}
+
+async_logger::~async_logger() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop.store(true, std::memory_order_release);
+    }
+
+    m_cv.notify_one();
+    m_writer.join();
+}
+
+async_logger::ring&
+async_logger::local_ring()
+{
+    if (local_handle.id == m_id)
+        return *local_handle.ring;
+
+    local_handle.release();
+
+    std::shared_ptr<ring> found;
+
+    {
+        std::lock_guard<std::mutex> lock(m_rings_mutex);
+
+        for (auto& elem : m_rings) {
+            bool owned = false;
+            if (elem->owned.compare_exchange_strong(
+                  owned, true, std::memory_order_acquire)) {
+                found = elem;
+                break;
+            }
+        }
+
+        if (not found) {
+            found = std::make_shared<ring>();
+            m_rings.emplace_back(found);
+            m_rings_size.store(m_rings.size(), std::memory_order_release);
+        }
+    }
+
+    local_handle.ring = std::move(found);
+    local_handle.id = m_id;
+
+    return *local_handle.ring;
+}
+
+void
+async_logger::push(context::message_type type, std::string msg)
+{
+    auto& r = local_ring();
+    const auto head = r.head.load(std::memory_order_relaxed);
+
+    // The ring is full: wake up the writer thread and wait for a free entry
+    // instead of losing the message.
+    while (head - r.tail.load(std::memory_order_acquire) >= ring_capacity) {
+        m_cv.notify_one();
+        std::this_thread::yield();
+    }
+
+    auto& entry = r.entries[head & (ring_capacity - 1)];
+    entry.type = type;
+    entry.msg = std::move(msg);
+    r.head.store(head + 1, std::memory_order_release);
+
+    // A notification lost between the test and the wait of the writer
+    // thread only delays the message to the next writer period.
+    if (m_sleeping.load(std::memory_order_relaxed))
+        m_cv.notify_one();
+}
+
+void
+async_logger::flush() noexcept
+{
+    std::vector<std::pair<ring*, std::size_t>> heads;
+
+    {
+        std::lock_guard<std::mutex> lock(m_rings_mutex);
+
+        for (auto& elem : m_rings)
+            heads.emplace_back(elem.get(),
+                               elem->head.load(std::memory_order_acquire));
+    }
+
+    for (auto& elem : heads) {
+        while (elem.first->tail.load(std::memory_order_acquire) <
+               elem.second) {
+            m_cv.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
+    if (m_file)
+        std::fflush(m_file);
+}
+
+std::size_t
+async_logger::drain(ring& r)
+{
+    const auto tail = r.tail.load(std::memory_order_relaxed);
+    const auto head = r.head.load(std::memory_order_acquire);
+
+    for (auto i = tail; i != head; ++i) {
+        auto& entry = r.entries[i & (ring_capacity - 1)];
+
+        if (m_file) {
+            std::fwrite(entry.msg.data(), 1, entry.msg.size(), m_file);
+        } else if (m_string_logger) {
+            try {
+                m_string_logger(entry.type, std::move(entry.msg));
+            } catch (...) {
+            }
+        }
+
+        entry.msg.clear();
+        r.tail.store(i + 1, std::memory_order_release);
+    }
+
+    return head - tail;
+}
+
+void
+async_logger::run() noexcept
+{
+    std::vector<std::shared_ptr<ring>> rings;
+
+    for (;;) {
+        const bool stop = m_stop.load(std::memory_order_acquire);
+
+        if (rings.size() != m_rings_size.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+            rings = m_rings;
+        }
+
+        std::size_t written = 0;
+        for (auto& elem : rings)
+            written += drain(*elem);
+
+        if (written) {
+            if (m_file)
+                std::fflush(m_file);
+            continue;
+        }
+
+        if (stop)
+            return;
+
+        // The destructor stores the stop flag under the mutex, it can not be
+        // missed between this test and the wait.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_stop.load(std::memory_order_acquire))
+            continue;
+
+        m_sleeping.store(true, std::memory_order_relaxed);
+        m_cv.wait_for(lock, writer_period);
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+} // namespace baryonyx
@@ -0,0 +1,87 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ORG_VLEPROJECT_BARYONYX_SOLVER_ASYNC_LOGGER_HPP
+#define ORG_VLEPROJECT_BARYONYX_SOLVER_ASYNC_LOGGER_HPP
+
+#include <baryonyx/core>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace baryonyx {
+
+/**
+ * @brief Asynchronous backend of the logging system.
+ *
+ * @details Each producer thread owns a single producer, single consumer ring
+ *     buffer: a push only moves the message into the ring and publishes the
+ *     new head with an atomic store. A writer thread drains all the rings
+ *     into the C file or into the string logger. A ring is acquired, under
+ *     a mutex, at the first message of a thread and is released when the
+ *     thread exits so that the threads of the next solve reuse it.
+ */
+class async_logger
+{
+public:
+    async_logger(FILE* file, context::string_logger_functor string_logger);
+    ~async_logger() noexcept;
+
+    async_logger(const async_logger&) = delete;
+    async_logger& operator=(const async_logger&) = delete;
+
+    void push(context::message_type type, std::string msg);
+
+    void flush() noexcept;
+
+    struct ring;
+
+private:
+    ring& local_ring();
+    std::size_t drain(ring& r);
+    void run() noexcept;
+
+    std::vector<std::shared_ptr<ring>> m_rings;
+    std::mutex m_rings_mutex;
+    std::atomic<std::size_t> m_rings_size{ 0 };
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<bool> m_sleeping{ false };
+    std::atomic<bool> m_stop{ false };
+
+    context::string_logger_functor m_string_logger;
+    FILE* m_file;
+    std::uint64_t m_id;
+    std::thread m_writer;
+};
+
+} // namespace baryonyx
+
+#endif
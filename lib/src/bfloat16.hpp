@@ -0,0 +1,102 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ORG_VLEPROJECT_BARYONYX_SOLVER_BFLOAT16_HPP
+#define ORG_VLEPROJECT_BARYONYX_SOLVER_BFLOAT16_HPP
+
+#include <cstdint>
+#include <cstring>
+
+namespace baryonyx {
+
+/**
+ * @brief A 16 bits brain floating point (bfloat16) storage type.
+ *
+ * @details @c bfloat16 keeps the sign, the 8 bits exponent and the 7 upper
+ *     bits of the mantissa of an IEEE 754 single precision float. It is
+ *     only used as a storage type (for example the preference matrix P):
+ *     values are converted to @c float before each computation and rounded
+ *     to the nearest even when stored.
+ */
+struct bfloat16
+{
+    std::uint16_t bits = 0;
+
+    bfloat16() = default;
+
+    bfloat16(float value) noexcept
+      : bits(from_float(value))
+    {}
+
+    operator float() const noexcept
+    {
+        std::uint32_t tmp = static_cast<std::uint32_t>(bits) << 16;
+        float ret;
+
+        std::memcpy(&ret, &tmp, sizeof(ret));
+
+        return ret;
+    }
+
+    bfloat16& operator+=(float value) noexcept
+    {
+        bits = from_float(static_cast<float>(*this) + value);
+        return *this;
+    }
+
+    bfloat16& operator-=(float value) noexcept
+    {
+        bits = from_float(static_cast<float>(*this) - value);
+        return *this;
+    }
+
+    bfloat16& operator*=(float value) noexcept
+    {
+        bits = from_float(static_cast<float>(*this) * value);
+        return *this;
+    }
+
+    bfloat16 operator-() const noexcept
+    {
+        bfloat16 ret;
+        ret.bits = bits ^ 0x8000u;
+        return ret;
+    }
+
+    static std::uint16_t from_float(float value) noexcept
+    {
+        std::uint32_t tmp;
+        std::memcpy(&tmp, &value, sizeof(tmp));
+
+        // Keep NaN quiet, otherwise the rounding can turn it into infinity.
+        if ((tmp & 0x7fffffffu) > 0x7f800000u)
+            return static_cast<std::uint16_t>((tmp >> 16) | 0x0040u);
+
+        tmp += 0x7fffu + ((tmp >> 16) & 1u);
+
+        return static_cast<std::uint16_t>(tmp >> 16);
+    }
+};
+
+} // namespace baryonyx
+
+#endif
@@ -0,0 +1,203 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ORG_VLEPROJECT_BARYONYX_SOLVER_BIT_ARRAY_HPP
+#define ORG_VLEPROJECT_BARYONYX_SOLVER_BIT_ARRAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+
+namespace baryonyx {
+
+/**
+ * @brief Number of bits set in @c word.
+ */
+inline int
+popcount(std::uint64_t word) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int ret = 0;
+    for (; word; word &= word - 1)
+        ++ret;
+
+    return ret;
+#endif
+}
+
+/**
+ * @brief A fixed size array of bits packed in 64 bits words.
+ *
+ * @details @c bit_array stores the boolean variables of a solver: eight
+ *     times smaller than an array of @c std::int8_t and readable one word at
+ *     a time to compute the value of a constraint with @c popcount. Like
+ *     @c std::bitset, the non-const accessors return a proxy @c reference
+ *     and the const accessors return the value (0 or 1) of the bit. The
+ *     unused bits of the last word are always 0.
+ */
+class bit_array
+{
+public:
+    using word_type = std::uint64_t;
+
+    static constexpr int word_bits = 64;
+
+    class reference
+    {
+    public:
+        reference(word_type& word, word_type mask) noexcept
+          : m_word(word)
+          , m_mask(mask)
+        {}
+
+        reference(const reference&) = default;
+
+        reference& operator=(int value) noexcept
+        {
+            if (value)
+                m_word |= m_mask;
+            else
+                m_word &= ~m_mask;
+
+            return *this;
+        }
+
+        reference& operator=(const reference& other) noexcept
+        {
+            return *this = static_cast<int>(other);
+        }
+
+        operator int() const noexcept
+        {
+            return (m_word & m_mask) != 0;
+        }
+
+    private:
+        word_type& m_word;
+        word_type m_mask;
+    };
+
+    bit_array() noexcept = default;
+
+    explicit bit_array(std::size_t n)
+      : m_size(n)
+      , m_words(n ? std::make_unique<word_type[]>(words(n)) : nullptr)
+    {
+        std::fill_n(m_words.get(), words(n), word_type{ 0 });
+    }
+
+    bit_array(bit_array&&) = default;
+    bit_array& operator=(bit_array&&) = default;
+
+    bit_array(const bit_array& other)
+      : bit_array(other.m_size)
+    {
+        std::copy_n(other.m_words.get(), words(m_size), m_words.get());
+    }
+
+    bit_array& operator=(const bit_array& other)
+    {
+        if (this != &other) {
+            if (m_size != other.m_size)
+                bit_array(other.m_size).swap(*this);
+
+            std::copy_n(other.m_words.get(), words(m_size), m_words.get());
+        }
+
+        return *this;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    reference operator[](std::size_t i) noexcept
+    {
+        return reference(m_words[i / word_bits], mask(i));
+    }
+
+    int operator[](std::size_t i) const noexcept
+    {
+        return (m_words[i / word_bits] & mask(i)) != 0;
+    }
+
+    reference operator()(std::size_t i) noexcept
+    {
+        return (*this)[i];
+    }
+
+    int operator()(std::size_t i) const noexcept
+    {
+        return (*this)[i];
+    }
+
+    /**
+     * @brief The words of the array: the bit @c i is the bit @c i % 64 of
+     *     the word @c i / 64.
+     */
+    const word_type* data() const noexcept
+    {
+        return m_words.get();
+    }
+
+    word_type* data() noexcept
+    {
+        return m_words.get();
+    }
+
+    void swap(bit_array& other) noexcept
+    {
+        std::swap(m_size, other.m_size);
+        std::swap(m_words, other.m_words);
+    }
+
+    /**
+     * @brief The number of words used to store @c n bits.
+     */
+    static constexpr std::size_t words(std::size_t n) noexcept
+    {
+        return (n + word_bits - 1) / word_bits;
+    }
+
+private:
+    static constexpr word_type mask(std::size_t i) noexcept
+    {
+        return word_type{ 1 } << (i % word_bits);
+    }
+
+    std::size_t m_size = 0;
+    std::unique_ptr<word_type[]> m_words;
+};
+
+} // namespace baryonyx
+
+#endif
@@ -0,0 +1,186 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ORG_VLEPROJECT_BARYONYX_SOLVER_BOUNDED_KNAPSACK_SOLVER_HPP
+#define ORG_VLEPROJECT_BARYONYX_SOLVER_BOUNDED_KNAPSACK_SOLVER_HPP
+
+#include "fixed_2darray.hpp"
+#include "fixed_array.hpp"
+#include "private.hpp"
+
+#include <limits>
+
+#include <cassert>
+
+namespace baryonyx {
+namespace details {
+
+/**
+ * @brief Dynamic programming for the bounded multiple-choice knapsack.
+ *
+ * @details Each item @c i selects a number of units @c v in
+ *     @c [0, upper], every unit uses @c factor of the capacity and costs
+ *     @c r. @c best(i, s) is the best cost of the first @c i items with a
+ *     sum of exactly @c s, so the lower bound of the sum is satisfied
+ *     exactly and not only the capacity.
+ */
+template<typename modeT, typename floatingpointT>
+struct bounded_knapsack_dp_solver
+{
+    struct item
+    {
+        floatingpointT r = 0.0;
+        int factor = 0;
+        int upper = 0;
+    };
+
+    fixed_array<item> items;
+    fixed_2darray<floatingpointT> best;
+    fixed_2darray<int> units;
+    int capacity;
+
+    bounded_knapsack_dp_solver(std::size_t size_, int capacity_)
+      : items(size_)
+      , best(size_ + 1, capacity_ + 1, 0)
+      , units(size_ + 1, capacity_ + 1, 0)
+      , capacity(capacity_)
+    {}
+
+    static bool is_better(floatingpointT lhs,
+                          floatingpointT rhs,
+                          maximize_tag) noexcept
+    {
+        return lhs > rhs;
+    }
+
+    static bool is_better(floatingpointT lhs,
+                          floatingpointT rhs,
+                          minimize_tag) noexcept
+    {
+        return lhs < rhs;
+    }
+
+    static floatingpointT init(maximize_tag) noexcept
+    {
+        return -std::numeric_limits<floatingpointT>::infinity();
+    }
+
+    static floatingpointT init(minimize_tag) noexcept
+    {
+        return +std::numeric_limits<floatingpointT>::infinity();
+    }
+
+    /**
+     * @brief Assigns the units of the items to @c values.
+     *
+     * @return the sum of the selection in @c [lower, capacity] or -1 if no
+     *     selection reaches @c lower.
+     */
+    template<typename V>
+    int solve(int lower, V& values)
+    {
+        const int n = static_cast<int>(items.size());
+        const floatingpointT none = init(modeT());
+
+        for (int s = 1; s <= capacity; ++s)
+            best(0, s) = none;
+
+        for (int i = 1; i <= n; ++i) {
+            const auto& elem = items[i - 1];
+
+            for (int s = 0; s <= capacity; ++s) {
+                best(i, s) = best(i - 1, s);
+                units(i, s) = 0;
+
+                for (int v = 1; v <= elem.upper and v * elem.factor <= s;
+                     ++v) {
+                    const auto previous = best(i - 1, s - v * elem.factor);
+
+                    if (previous == none)
+                        continue;
+
+                    const auto cost = previous + v * elem.r;
+                    if (best(i, s) == none or
+                        is_better(cost, best(i, s), modeT())) {
+                        best(i, s) = cost;
+                        units(i, s) = v;
+                    }
+                }
+            }
+        }
+
+        int sum = -1;
+        for (int s = std::max(lower, 0); s <= capacity; ++s)
+            if (best(n, s) != none and
+                (sum < 0 or is_better(best(n, s), best(n, sum), modeT())))
+                sum = s;
+
+        if (sum < 0)
+            return -1;
+
+        for (int i = n, s = sum; i > 0; --i) {
+            values[i - 1] = units(i, s);
+            s -= units(i, s) * items[i - 1].factor;
+        }
+
+        return sum;
+    }
+};
+
+} // namespace details
+
+/*
+ * @note The factors of @c reduced_cost are read from @c ap in absolute
+ *     value: the negative coefficients are complemented by the caller.
+ */
+template<typename modeT,
+         typename floatingpointT,
+         typename AP,
+         typename R,
+         typename U,
+         typename V>
+int
+bounded_knapsack_dp_solver(const AP& ap,
+                           const R& reduced_cost,
+                           const U& upper,
+                           V& values,
+                           int r_size,
+                           int lower,
+                           int capacity)
+{
+    assert(capacity >= 0 && "No negative capacity");
+
+    details::bounded_knapsack_dp_solver<modeT, floatingpointT> slv(r_size,
+                                                                   capacity);
+
+    for (int i = 0; i != r_size; ++i) {
+        slv.items[i].r = reduced_cost[i].value;
+        slv.items[i].factor = std::abs(ap.A()[reduced_cost[i].id_P]);
+        slv.items[i].upper = upper[reduced_cost[i].id];
+    }
+
+    return slv.solve(lower, values);
+}
+
+} // namespace baryonyx
+
+#endif
@@ -0,0 +1,288 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <baryonyx/core>
+
+#include "private.hpp"
+#include "utils.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bx = baryonyx;
+
+namespace {
+
+//
+// A read-only view of the solution file. On POSIX systems the file is mapped
+// in memory, otherwise (or if the mapping fails) it is read into a buffer.
+//
+class mapped_file
+{
+public:
+    explicit mapped_file(const std::string& filename)
+    {
+#ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw bx::file_access_failure(filename, errno);
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 and st.st_size > 0) {
+            auto size = static_cast<std::size_t>(st.st_size);
+            void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (ptr != MAP_FAILED) {
+                ::madvise(ptr, size, MADV_SEQUENTIAL);
+                m_mapping = ptr;
+                m_data = static_cast<const char*>(ptr);
+                m_size = size;
+            }
+        }
+
+        ::close(fd);
+
+        if (m_mapping)
+            return;
+#endif
+
+        std::ifstream ifs(filename, std::ios::binary);
+        if (not ifs.is_open())
+            throw bx::file_access_failure(filename, errno);
+
+        m_buffer.assign(std::istreambuf_iterator<char>(ifs),
+                        std::istreambuf_iterator<char>());
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() noexcept
+    {
+#ifndef _WIN32
+        if (m_mapping)
+            ::munmap(m_mapping, m_size);
+#endif
+    }
+
+    const char* data() const noexcept
+    {
+        return m_data;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+private:
+    std::string m_buffer;
+    void* m_mapping = nullptr;
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+//
+// Variable names are looked up without building a @c std::string for each
+// assignment: keys point into the problem names or into the mapped file.
+//
+struct name_view
+{
+    const char* data;
+    std::size_t size;
+};
+
+struct name_view_hash
+{
+    std::size_t operator()(const name_view& n) const noexcept
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+
+        for (std::size_t i = 0; i != n.size; ++i) {
+            hash ^= static_cast<unsigned char>(n.data[i]);
+            hash *= 1099511628211ULL;
+        }
+
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+struct name_view_equal
+{
+    bool operator()(const name_view& lhs, const name_view& rhs) const noexcept
+    {
+        return lhs.size == rhs.size and
+               std::memcmp(lhs.data, rhs.data, lhs.size) == 0;
+    }
+};
+
+using name_index =
+  std::unordered_map<name_view, bx::index, name_view_hash, name_view_equal>;
+
+inline const bx::constraint&
+get_constraint(const bx::problem& pb, std::size_t i) noexcept
+{
+    if (i < pb.equal_constraints.size())
+        return pb.equal_constraints[i];
+
+    i -= pb.equal_constraints.size();
+    if (i < pb.greater_constraints.size())
+        return pb.greater_constraints[i];
+
+    return pb.less_constraints[i - pb.greater_constraints.size()];
+}
+
+inline bool
+is_satisfied(const bx::problem& pb,
+             std::size_t i,
+             const std::vector<int>& values) noexcept
+{
+    const auto& cst = get_constraint(pb, i);
+
+    long long v = 0;
+    for (const auto& elem : cst.elements)
+        v += static_cast<long long>(elem.factor) * values[elem.variable_index];
+
+    if (i < pb.equal_constraints.size())
+        return v == cst.value;
+
+    if (i < pb.equal_constraints.size() + pb.greater_constraints.size())
+        return v >= cst.value;
+
+    return v <= cst.value;
+}
+
+void
+check_constraints(const bx::problem& pb,
+                  const std::vector<int>& values,
+                  std::size_t begin,
+                  std::size_t end,
+                  std::vector<std::size_t>& violated)
+{
+    for (; begin != end; ++begin)
+        if (not is_satisfied(pb, begin, values))
+            violated.emplace_back(begin);
+}
+
+} // anonymous namespace
+
+namespace baryonyx_private {
+
+bx::solution_report
+check_solution(const std::shared_ptr<bx::context>& ctx,
+               const bx::problem& pb,
+               const std::string& filename)
+{
+    mapped_file file(filename);
+
+    name_index index;
+    index.reserve(pb.vars.names.size());
+
+    for (std::size_t i = 0, e = pb.vars.names.size(); i != e; ++i)
+        index.emplace(
+          name_view{ pb.vars.names[i].data(), pb.vars.names[i].size() },
+          static_cast<bx::index>(i));
+
+    bx::solution_report report;
+    std::vector<int> values(pb.vars.names.size(), 0);
+
+    read_result_assignments(
+      file.data(),
+      file.size(),
+      [&index, &values, &report](const char* name, std::size_t size, int v) {
+          auto it = index.find(name_view{ name, size });
+
+          if (it == index.end())
+              ++report.unknown_variables;
+          else
+              values[it->second] = v;
+      });
+
+    const std::size_t constraints = pb.equal_constraints.size() +
+                                    pb.greater_constraints.size() +
+                                    pb.less_constraints.size();
+
+    auto thread = ctx->get_integer_parameter(
+      "thread", std::thread::hardware_concurrency());
+    std::size_t workers = thread <= 0 ? 1 : static_cast<std::size_t>(thread);
+    workers = std::max(std::size_t(1), std::min(workers, constraints / 1024));
+
+    std::vector<std::vector<std::size_t>> violated(workers);
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+
+    const std::size_t chunk = (constraints + workers - 1) / workers;
+
+    for (std::size_t i = 1; i < workers; ++i) {
+        const std::size_t begin = std::min(i * chunk, constraints);
+        const std::size_t end = std::min(begin + chunk, constraints);
+
+        pool.emplace_back(check_constraints,
+                          std::cref(pb),
+                          std::cref(values),
+                          begin,
+                          end,
+                          std::ref(violated[i]));
+    }
+
+    check_constraints(
+      pb, values, 0, std::min(chunk, constraints), violated.front());
+
+    report.value = pb.objective.value;
+    for (const auto& elem : pb.objective.elements)
+        report.value += elem.factor * values[elem.variable_index];
+
+    for (auto& t : pool)
+        t.join();
+
+    for (const auto& part : violated) {
+        for (auto i : part) {
+            const auto& cst = get_constraint(pb, i);
+
+            report.violated_constraints.emplace_back(
+              cst.label.empty() ? fmt::format("ct{}", cst.id) : cst.label);
+        }
+    }
+
+    report.valid = report.violated_constraints.empty();
+
+    return report;
+}
+
+} // namespace baryonyx_private
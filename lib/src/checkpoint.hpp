@@ -0,0 +1,354 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ORG_VLEPROJECT_BARYONYX_SOLVER_CHECKPOINT_HPP
+#define ORG_VLEPROJECT_BARYONYX_SOLVER_CHECKPOINT_HPP
+
+#include <baryonyx/core>
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace baryonyx {
+
+// The first bytes of a checkpoint file.
+constexpr char checkpoint_magic[8] = { 'B', 'X', 'C', 'K', 'P', 'T', '0', '1' };
+
+/**
+ * @brief 64 bits FNV-1a hash of a sequence of bytes.
+ */
+class hasher
+{
+public:
+    void add(const void* data, std::size_t size) noexcept
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+
+        for (std::size_t i = 0; i != size; ++i) {
+            m_value ^= bytes[i];
+            m_value *= 1099511628211ull;
+        }
+    }
+
+    template<typename T>
+    void add(const T& value) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Trivially copyable type required.");
+
+        add(&value, sizeof(T));
+    }
+
+    void add(const std::string& str) noexcept
+    {
+        add(str.size());
+        add(str.data(), str.size());
+    }
+
+    std::uint64_t value() const noexcept
+    {
+        return m_value;
+    }
+
+private:
+    std::uint64_t m_value = 14695981039346656037ull;
+};
+
+/**
+ * @brief Settings of the checkpoints of the optimizer threads.
+ *
+ * @details With the @c checkpoint parameter, each thread of the optimizer
+ *     writes its state into the file @c checkpoint.thread every
+ *     @c checkpoint-period seconds and when it stops. The @c resume parameter (the @c --resume
+ *     option) restarts the threads from the files @c resume.thread; the
+ *     checkpoints continue in the same files if @c checkpoint is not set. A
+ *     checkpoint is accepted only if it was written for the same
+ *     preprocessed problem (@c hash) and the same thread.
+ */
+class checkpoint
+{
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    checkpoint(const std::shared_ptr<context>& ctx, std::uint64_t hash)
+      : m_path(ctx->get_string_parameter("checkpoint", ""))
+      , m_resume(ctx->get_string_parameter("resume", ""))
+      , m_period(std::chrono::duration_cast<time_point::duration>(
+          std::chrono::duration<double>(
+            std::max(0.0, ctx->get_real_parameter("checkpoint-period", 60)))))
+      , m_hash(hash)
+    {
+        if (m_path.empty())
+            m_path = m_resume;
+    }
+
+    bool write() const noexcept
+    {
+        return not m_path.empty();
+    }
+
+    bool resume() const noexcept
+    {
+        return not m_resume.empty();
+    }
+
+    time_point::duration period() const noexcept
+    {
+        return m_period;
+    }
+
+    std::uint64_t hash() const noexcept
+    {
+        return m_hash;
+    }
+
+    std::string filename(int thread) const
+    {
+        return fmt::format("{}.{}", m_path, thread);
+    }
+
+    std::string resume_filename(int thread) const
+    {
+        return fmt::format("{}.{}", m_resume, thread);
+    }
+
+private:
+    std::string m_path;
+    std::string m_resume;
+    time_point::duration m_period;
+    std::uint64_t m_hash;
+};
+
+/**
+ * @brief Writes the checkpoint of a thread into a temporary file renamed
+ *     on @c commit() so a preempted write never replaces the previous
+ *     checkpoint.
+ */
+class checkpoint_writer
+{
+public:
+    checkpoint_writer(const checkpoint& ckp, int thread)
+      : m_filename(ckp.filename(thread))
+      , m_temporary(m_filename + ".tmp")
+      , m_ofs(m_temporary, std::ios::binary | std::ios::trunc)
+    {
+        m_ofs.write(checkpoint_magic, sizeof(checkpoint_magic));
+        write(ckp.hash());
+        write(thread);
+    }
+
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Trivially copyable type required.");
+
+        m_ofs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    void write(const T* data, std::size_t size)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Trivially copyable type required.");
+
+        write(static_cast<std::uint64_t>(size));
+        m_ofs.write(reinterpret_cast<const char*>(data), size * sizeof(T));
+    }
+
+    void write(const std::string& str)
+    {
+        write(str.data(), str.size());
+    }
+
+    bool commit()
+    {
+        m_ofs.close();
+
+        if (not m_ofs)
+            return false;
+
+        return std::rename(m_temporary.c_str(), m_filename.c_str()) == 0;
+    }
+
+private:
+    std::string m_filename;
+    std::string m_temporary;
+    std::ofstream m_ofs;
+};
+
+/**
+ * @brief Reads the checkpoint of a thread written by @c checkpoint_writer.
+ *
+ * @details The reader is invalid if the file does not exist, if it is
+ *     truncated or if it was written for another problem or another
+ *     thread, @c error() explains why.
+ */
+class checkpoint_reader
+{
+public:
+    checkpoint_reader(const checkpoint& ckp, int thread)
+      : m_ifs(ckp.resume_filename(thread), std::ios::binary)
+    {
+        if (not m_ifs) {
+            m_error = "no file";
+            return;
+        }
+
+        m_ifs.seekg(0, std::ios::end);
+        m_size = static_cast<std::streamoff>(m_ifs.tellg());
+        m_ifs.seekg(0, std::ios::beg);
+
+        char buffer[sizeof(checkpoint_magic)];
+        m_ifs.read(buffer, sizeof(buffer));
+
+        if (not m_ifs or
+            std::memcmp(buffer, checkpoint_magic, sizeof(buffer)) != 0) {
+            m_error = "bad format";
+            return;
+        }
+
+        std::uint64_t hash = 0;
+        int id = -1;
+
+        if (not read(hash) or hash != ckp.hash()) {
+            m_error = "different problem";
+            return;
+        }
+
+        if (not read(id) or id != thread)
+            m_error = "different thread";
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_error == nullptr;
+    }
+
+    const char* error() const noexcept
+    {
+        return m_error;
+    }
+
+    template<typename T>
+    bool read(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Trivially copyable type required.");
+
+        m_ifs.read(reinterpret_cast<char*>(&value), sizeof(T));
+
+        return check();
+    }
+
+    /**
+     * @brief Reads an array of @c size elements, fails if the array of the
+     *     file has another size.
+     */
+    template<typename T>
+    bool read(T* data, std::size_t size)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Trivially copyable type required.");
+
+        std::uint64_t stored = 0;
+        if (not read(stored))
+            return false;
+
+        if (stored != size) {
+            m_error = "different size";
+            return false;
+        }
+
+        m_ifs.read(reinterpret_cast<char*>(data), size * sizeof(T));
+
+        return check();
+    }
+
+    /**
+     * @brief Reads an array of any size, fails if the array is larger than
+     *     the rest of the file.
+     */
+    template<typename T>
+    bool read(std::vector<T>& data)
+    {
+        std::uint64_t stored = 0;
+        if (not read(stored))
+            return false;
+
+        if (stored > remaining() / sizeof(T)) {
+            m_error = "bad size";
+            return false;
+        }
+
+        data.resize(static_cast<std::size_t>(stored));
+        m_ifs.read(reinterpret_cast<char*>(data.data()),
+                   data.size() * sizeof(T));
+
+        return check();
+    }
+
+    bool read(std::string& str)
+    {
+        std::vector<char> buffer;
+        if (not read(buffer))
+            return false;
+
+        str.assign(buffer.begin(), buffer.end());
+
+        return true;
+    }
+
+private:
+    bool check() noexcept
+    {
+        if (not m_ifs)
+            m_error = "truncated file";
+
+        return m_error == nullptr;
+    }
+
+    std::uint64_t remaining()
+    {
+        const auto position = static_cast<std::streamoff>(m_ifs.tellg());
+
+        return position < 0 or position > m_size
+                 ? 0
+                 : static_cast<std::uint64_t>(m_size - position);
+    }
+
+    std::ifstream m_ifs;
+    std::streamoff m_size = 0;
+    const char* m_error = nullptr;
+};
+
+} // namespace baryonyx
+
+#endif
@@ -0,0 +1,279 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <baryonyx/core>
+
+#include "private.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace bx = baryonyx;
+
+namespace {
+
+//
+// Union-find with path halving and union by size over the variables of the
+// problem.
+//
+class disjoint_sets
+{
+public:
+    explicit disjoint_sets(int n)
+      : parent(n)
+      , size(n, 1)
+    {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    int find(int x) noexcept
+    {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+
+        return x;
+    }
+
+    void merge(int x, int y) noexcept
+    {
+        x = find(x);
+        y = find(y);
+
+        if (x == y)
+            return;
+
+        if (size[x] < size[y])
+            std::swap(x, y);
+
+        parent[y] = x;
+        size[x] += size[y];
+    }
+
+private:
+    std::vector<int> parent;
+    std::vector<int> size;
+};
+
+void
+merge_variables(disjoint_sets& sets,
+                const std::vector<bx::constraint>& csts,
+                std::vector<bool>& constrained)
+{
+    for (const auto& cst : csts) {
+        if (cst.elements.empty())
+            continue;
+
+        const auto first = cst.elements.front().variable_index;
+        constrained[first] = true;
+
+        for (const auto& elem : cst.elements) {
+            sets.merge(first, elem.variable_index);
+            constrained[elem.variable_index] = true;
+        }
+    }
+}
+
+//
+// Moves the constraints of @c csts into the list @c member of the component
+// of their variables. Variable indices are renumbered into the component.
+//
+void
+split_constraints(std::vector<bx::constraint>& csts,
+                  std::vector<bx::constraint> bx::problem::*member,
+                  const std::vector<int>& component,
+                  const std::vector<int>& position,
+                  std::vector<bx::problem>& components)
+{
+    for (auto& cst : csts) {
+        if (cst.elements.empty())
+            continue;
+
+        const auto c = component[cst.elements.front().variable_index];
+
+        for (auto& elem : cst.elements)
+            elem.variable_index = position[elem.variable_index];
+
+        (components[c].*member).emplace_back(std::move(cst));
+    }
+}
+
+} // anonymous namespace
+
+namespace baryonyx_private {
+
+decomposition
+decompose(const std::shared_ptr<bx::context>& ctx, bx::problem& pb)
+{
+    decomposition ret;
+
+    if (ctx->get_integer_parameter("decomposition", 0) == 0)
+        return ret;
+
+    const auto n = bx::numeric_cast<int>(pb.vars.values.size());
+    disjoint_sets sets(n);
+    std::vector<bool> constrained(n, false);
+
+    merge_variables(sets, pb.equal_constraints, constrained);
+    merge_variables(sets, pb.greater_constraints, constrained);
+    merge_variables(sets, pb.less_constraints, constrained);
+
+    // Components are numbered in the order of their first variable.
+    // Variables without constraint are attached to the first component.
+
+    std::vector<int> component(n, -1);
+    std::vector<int> root(n, -1);
+    int size = 0;
+
+    for (int i = 0; i != n; ++i) {
+        if (not constrained[i])
+            continue;
+
+        const auto r = sets.find(i);
+        if (root[r] < 0)
+            root[r] = size++;
+
+        component[i] = root[r];
+    }
+
+    if (size <= 1)
+        return ret;
+
+    for (int i = 0; i != n; ++i)
+        if (component[i] < 0)
+            component[i] = 0;
+
+    info(ctx, "  - decomposition: {} independent components\n", size);
+
+    ret.components.resize(size);
+    ret.variables.resize(size);
+
+    std::vector<int> position(n);
+    for (int i = 0; i != n; ++i) {
+        const auto c = component[i];
+        auto& sub = ret.components[c];
+
+        position[i] = bx::numeric_cast<int>(ret.variables[c].size());
+        ret.variables[c].emplace_back(i);
+        sub.vars.names.emplace_back(pb.vars.names[i]);
+        sub.vars.values.emplace_back(pb.vars.values[i]);
+    }
+
+    for (auto& elem : pb.objective.elements) {
+        const auto c = component[elem.variable_index];
+        elem.variable_index = position[elem.variable_index];
+        ret.components[c].objective.elements.emplace_back(elem);
+    }
+
+    split_constraints(pb.equal_constraints,
+                      &bx::problem::equal_constraints,
+                      component,
+                      position,
+                      ret.components);
+    split_constraints(pb.greater_constraints,
+                      &bx::problem::greater_constraints,
+                      component,
+                      position,
+                      ret.components);
+    split_constraints(pb.less_constraints,
+                      &bx::problem::less_constraints,
+                      component,
+                      position,
+                      ret.components);
+
+    for (auto& sub : ret.components)
+        sub.type = pb.type;
+
+    // The constant of the objective function and the variables already
+    // affected are kept once, in the first component and in the
+    // decomposition.
+
+    ret.components.front().objective.value = pb.objective.value;
+    ret.names = std::move(pb.vars.names);
+    ret.affected_vars = std::move(pb.affected_vars);
+
+    bx::clear(pb);
+
+    for (int c = 0; c != size; ++c)
+        debug(ctx,
+              "    component {}: {} variables, {} constraints\n",
+              c,
+              ret.components[c].vars.values.size(),
+              bx::size(ret.components[c]));
+
+    return ret;
+}
+
+bx::result
+merge(decomposition& dec, std::vector<bx::result>& results)
+{
+    bx::Expects(dec.components.size() == results.size());
+
+    bx::result ret;
+    ret.status = bx::result_status::success;
+    ret.remaining_constraints = 0;
+    ret.variable_value.resize(dec.names.size(), 0);
+
+    for (std::size_t c = 0, e = results.size(); c != e; ++c) {
+        auto& r = results[c];
+        const auto& variables = dec.variables[c];
+
+        if (r.variable_value.size() == variables.size())
+            for (std::size_t i = 0, ei = variables.size(); i != ei; ++i)
+                ret.variable_value[variables[i]] = r.variable_value[i];
+
+        for (std::size_t i = 0, ei = r.affected_vars.names.size(); i != ei;
+             ++i)
+            dec.affected_vars.push_back(r.affected_vars.names[i],
+                                        r.affected_vars.values[i]);
+
+        if (ret.status == bx::result_status::success and
+            r.status != bx::result_status::success)
+            ret.status = r.status;
+
+        if (r.remaining_constraints == std::numeric_limits<bx::index>::max() or
+            ret.remaining_constraints ==
+              std::numeric_limits<bx::index>::max())
+            ret.remaining_constraints = std::numeric_limits<bx::index>::max();
+        else
+            ret.remaining_constraints += r.remaining_constraints;
+
+        ret.value += r.value;
+        ret.duration = std::max(ret.duration, r.duration);
+        ret.loop += r.loop;
+        ret.variables += r.variables;
+        ret.constraints += r.constraints;
+        ret.memory_estimate += r.memory_estimate;
+    }
+
+    ret.method = "decomposition (" + std::to_string(results.size()) +
+                 " components): " + results.front().method;
+    ret.seed = results.front().seed;
+    ret.variable_name = std::move(dec.names);
+    ret.affected_vars = std::move(dec.affected_vars);
+
+    return ret;
+}
+
+} // namespace baryonyx_private
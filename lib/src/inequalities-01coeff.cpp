@@ -309,8 +309,10 @@ struct solver
     // Vector shared between all constraints to store the reduced cost.
     bx::fixed_array<r_data<floatingpoint_type>> R;
 
-    // Vector for each constraint with negative coefficients.
-    bx::fixed_array<bx::fixed_array<c_data>> C;
+    // Negative coefficients of all the constraints in one block: entries of
+    // the constraint k are C[C_access[k]] to C[C_access[k + 1]].
+    bx::fixed_array<int> C_access;
+    bx::fixed_array<c_data> C;
 
     // Bound vector.
     b_type b;
@@ -326,7 +328,7 @@ struct solver
            const std::vector<bx::itm::merged_constraint>& csts)
       : rng(rng_)
       , ap(length(csts), n_)
-      , C(length(csts))
+      , C_access(length(csts) + 1, 0)
       , b(length(csts))
       , c(c_)
       , x(n_)
@@ -334,25 +336,10 @@ struct solver
       , m(length(csts))
       , n(n_)
     {
-        {
-            // Compute the number of elements in the matrix A then compute for
-            // each rows and columns the number of elements to correctly
-            // initialize the @c `matrix` structure.
-
-            bx::fixed_array<int> rinit(m, 0), cinit(n, 0);
-            int elem{ 0 };
+        // Build the rows and the columns of the @c `matrix` structure in one
+        // pass, already sorted.
 
-            for (int i{ 0 }, e{ length(csts) }; i != e; ++i) {
-                for (const auto& cst : csts[i].elements) {
-                    rinit[i]++;
-                    cinit[cst.variable_index]++;
-                    ++elem;
-                }
-            }
-
-            ap.reserve(
-              elem, rinit.begin(), rinit.end(), cinit.begin(), cinit.end());
-        }
+        ap.build(csts);
 
         {
             // Compute the minimal bounds for each constraints, default
@@ -364,8 +351,6 @@ struct solver
                 int lower = 0, upper = 0;
 
                 for (const auto& cst : csts[i].elements) {
-                    ap.set(i, cst.variable_index, cst.factor, 0.0);
-
                     if (cst.factor > 0)
                         ++upper;
 
@@ -393,8 +378,6 @@ struct solver
                     }
                 }
             }
-
-            ap.sort();
         }
 
         {
@@ -414,22 +397,26 @@ struct solver
                 }
 
                 rsizemax = std::max(rsizemax, rsize);
+                C_access[i + 1] = C_access[i] + csize;
+            }
 
-                if (csize <= 0) // No negative coefficient found in
-                    continue;   // constraint, try the next.
+            C = bx::fixed_array<c_data>(C_access[length(csts)]);
 
-                C[i] = bx::fixed_array<c_data>(csize);
+            for (int i = 0, e = length(csts); i != e; ++i) {
+                // No negative coefficient found in constraint, try the next.
+                if (C_access[i] == C_access[i + 1])
+                    continue;
 
                 int id_in_r = 0;
-                int id_in_c = 0;
+                int id_in_c = C_access[i];
 
                 typename AP_type<floatingpoint_type>::const_iterator it, et;
                 std::tie(it, et) = ap.row(i);
 
                 for (; it != et; ++it) {
                     if (ap.A()[it->value] < 0) {
-                        C[i][id_in_c].id_r = id_in_r;
-                        C[i][id_in_c].id_A = it->position;
+                        C[id_in_c].id_r = id_in_r;
+                        C[id_in_c].id_A = it->position;
                         ++id_in_c;
                     }
                     ++id_in_r;
@@ -570,8 +557,8 @@ struct solver
 
         decrease_preference(it, et, theta);
 
-        const auto& ck = C[k];
-        const int c_size = length(ck);
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
         const int r_size = compute_reduced_costs(it, et);
 
         //
@@ -615,8 +602,8 @@ struct solver
 
         decrease_preference(it, et, theta);
 
-        const auto& ck = C[k];
-        const int c_size = (ck) ? length(ck) : 0;
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
         const int r_size = compute_reduced_costs(it, et);
 
         //
@@ -654,7 +641,7 @@ struct solver
                             floatingpoint_type delta,
                             floatingpoint_type theta)
     {
-        if (!C[k]) {
+        if (C_access[k] == C_access[k + 1]) {
             if (b(k).min == b(k).max)
                 compute_update_row_01_eq(k, b(k).min, kappa, delta, theta);
             else
@@ -820,8 +807,8 @@ struct solver
         for (int i = 0; i != r_size; ++i)
             R[i].value += objective_amplifier * c[R[i].id];
 
-        const auto& ck = C[k];
-        const int c_size = (ck) ? length(ck) : 0;
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
 
         //
         // Negate reduced costs and coefficients of these variables. We need to
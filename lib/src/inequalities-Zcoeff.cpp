@@ -26,27 +26,36 @@
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <functional>
 #include <future>
 #include <iterator>
+#include <mutex>
 #include <random>
 #include <set>
+#include <sstream>
 #include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "bfloat16.hpp"
+#include "bit_array.hpp"
+#include "bounded-knapsack-solver.hpp"
 #include "branch-and-bound-solver.hpp"
+#include "checkpoint.hpp"
 #include "fixed_array.hpp"
 #include "itm.hpp"
 #include "knapsack-dp-solver.hpp"
+#include "local-search.hpp"
 #include "matrix.hpp"
 #include "private.hpp"
 #include "utils.hpp"
 
 #include <cassert>
+#include <cstring>
 
 namespace bx = baryonyx;
 
@@ -78,36 +87,43 @@ struct r_data
 {
     r_data() = default;
 
-    r_data(floatingpointT value_, int index_)
+    r_data(floatingpointT value_, int index_, int id_P_)
       : value(value_)
       , id(index_)
+      , id_P(id_P_)
     {}
 
     floatingpointT value; // reduced cost value
     int id;               // index in AP matrix
+    int id_P;             // index in A and P vectors
 };
 
 struct c_data
 {
     c_data() = default;
 
-    c_data(int id_A_, int id_r_)
+    c_data(int id_A_, int id_r_, int id_P_)
       : id_A(id_A_)
       , id_r(id_r_)
+      , id_P(id_P_)
     {}
 
     int id_A; // index in AP matrix
     int id_r; // index in r matrix
+    int id_P; // index in A and P vectors
 };
 
-template<typename floatingpointT>
-using AP_type = bx::SparseArray<int, floatingpointT>;
+template<typename preferenceT>
+using AP_type = bx::SparseArray<int, preferenceT>;
+
+template<typename preferenceT>
+using SharedAP_type = bx::SharedSparseArray<int, preferenceT>;
 
 using b_type = baryonyx::fixed_array<bound>;
 
 template<typename floatingpointT>
 using c_type = baryonyx::fixed_array<floatingpointT>;
-using x_type = baryonyx::fixed_array<std::int8_t>;
+using x_type = baryonyx::bit_array;
 
 template<typename floatingpointT>
 using pi_type = baryonyx::fixed_array<floatingpointT>;
@@ -233,14 +249,19 @@ init_x(int cost, int value_if_cost_0, bx::maximize_tag) noexcept
     return false;
 }
 
-template<typename apT, typename xT, typename bT>
-bool
-is_valid_solution(const apT& ap, const xT& x, const bT& b) noexcept
+template<typename apT, typename xT, typename bT, typename C>
+int
+compute_missing_constraint(const apT& ap,
+                           const xT& x,
+                           const bT& b,
+                           C& r) noexcept
 {
     typename apT::const_iterator it, et;
 
     const auto& va = ap.A();
 
+    r.clear();
+
     for (int k = 0, ek = length(b); k != ek; ++k) {
         std::tie(it, et) = ap.row(k);
         int v = 0;
@@ -248,6 +269,145 @@ is_valid_solution(const apT& ap, const xT& x, const bT& b) noexcept
         for (; it != et; ++it)
             v += va[it->value] * x[it->position];
 
+        if (not(b(k).min <= v and v <= b(k).max))
+            r.emplace_back(k);
+    }
+
+    return length(r);
+}
+
+//
+// Bitmaps of the constraints with only 1 coefficients and fewer distinct
+// words of @c x than variables: the value of such a constraint is the sum of
+// the popcounts of its masks and of the words of @c x they select. The
+// (word index, mask) pairs of the constraint k are words[access[k]] to
+// words[access[k + 1]], the variables of a constraint do not need to be
+// close. Other constraints have no pair.
+//
+struct row_bitmaps
+{
+    struct word_mask
+    {
+        int index;
+        bx::bit_array::word_type mask;
+    };
+
+    bx::fixed_array<int> access;
+    bx::fixed_array<word_mask> words;
+
+    template<typename apT>
+    void build(const apT& ap, int m)
+    {
+        constexpr int bits = bx::bit_array::word_bits;
+
+        bx::fixed_array<int>(m + 1, 0).swap(access);
+
+        std::vector<word_mask> pairs;
+        typename apT::const_iterator it, et;
+
+        for (int k = 0; k != m; ++k) {
+            access[k + 1] = access[k];
+            std::tie(it, et) = ap.row(k);
+
+            if (it == et)
+                continue;
+
+            if (std::any_of(it, et, [&ap](const auto& elem) {
+                    return ap.A()[elem.value] != 1;
+                }))
+                continue;
+
+            const auto row = pairs.size();
+            const auto size = static_cast<std::size_t>(et - it);
+
+            for (; it != et; ++it) {
+                const int index = it->position / bits;
+                const auto mask = bx::bit_array::word_type{ 1 }
+                                  << (it->position % bits);
+
+                // The variables of a row are mostly sorted: the word of the
+                // previous variable is checked first.
+
+                auto found = pairs.end();
+
+                if (pairs.size() > row and pairs.back().index == index)
+                    --found;
+                else
+                    found = std::find_if(
+                      pairs.begin() + row, pairs.end(), [index](const auto& w) {
+                          return w.index == index;
+                      });
+
+                if (found == pairs.end())
+                    pairs.push_back({ index, mask });
+                else
+                    found->mask |= mask;
+            }
+
+            if (pairs.size() - row >= size) {
+                pairs.resize(row);
+                continue;
+            }
+
+            access[k + 1] += static_cast<int>(pairs.size() - row);
+        }
+
+        bx::fixed_array<word_mask>(access[m]).swap(words);
+        std::copy(pairs.begin(), pairs.end(), words.begin());
+    }
+
+    template<typename apT>
+    int value(const apT& ap, const x_type& x, int k) const noexcept
+    {
+        if (access[k] != access[k + 1]) {
+            const auto* w = x.data();
+            int v = 0;
+
+            for (int i = access[k], e = access[k + 1]; i != e; ++i)
+                v += bx::popcount(words[i].mask & w[words[i].index]);
+
+            return v;
+        }
+
+        typename apT::const_iterator it, et;
+        std::tie(it, et) = ap.row(k);
+
+        const auto& va = ap.A();
+        int v = 0;
+
+        for (; it != et; ++it)
+            v += va[it->value] * x[it->position];
+
+        return v;
+    }
+
+    // The solution of the general integer variables has no bitmap.
+    template<typename apT, typename xT>
+    int value(const apT& ap, const xT& x, int k) const noexcept
+    {
+        typename apT::const_iterator it, et;
+        std::tie(it, et) = ap.row(k);
+
+        const auto& va = ap.A();
+        int v = 0;
+
+        for (; it != et; ++it)
+            v += va[it->value] * x[it->position];
+
+        return v;
+    }
+};
+
+template<typename apT, typename xT, typename bT>
+bool
+is_valid_solution(const apT& ap,
+                  const row_bitmaps& masks,
+                  const xT& x,
+                  const bT& b) noexcept
+{
+    for (int k = 0, ek = length(b); k != ek; ++k) {
+        const int v = masks.value(ap, x, k);
+
         if (not(b(k).min <= v and v <= b(k).max))
             return false;
     }
@@ -258,22 +418,15 @@ is_valid_solution(const apT& ap, const xT& x, const bT& b) noexcept
 template<typename apT, typename xT, typename bT, typename C>
 int
 compute_missing_constraint(const apT& ap,
+                           const row_bitmaps& masks,
                            const xT& x,
                            const bT& b,
                            C& r) noexcept
 {
-    typename apT::const_iterator it, et;
-
-    const auto& va = ap.A();
-
     r.clear();
 
     for (int k = 0, ek = length(b); k != ek; ++k) {
-        std::tie(it, et) = ap.row(k);
-        int v = 0;
-
-        for (; it != et; ++it)
-            v += va[it->value] * x[it->position];
+        const int v = masks.value(ap, x, k);
 
         if (not(b(k).min <= v and v <= b(k).max))
             r.emplace_back(k);
@@ -318,23 +471,25 @@ print_missing_constraint(const std::shared_ptr<baryonyx::context>& ctx,
     }
 }
 
-template<typename floatingpointT, typename modeT, typename randomT>
-struct solver
+//
+// The structure of the problem built once from the merged constraints: the A
+// matrix, the negative coefficients C, the Z flags, the bounds, the upper
+// bounds of the general integer variables and the solution of the file init
+// policy. It is shared read-only by the solvers of an optimization, each
+// solver owns the mutable P, R, pi and x.
+//
+template<typename preferenceT>
+struct solver_structure
 {
-    using floatingpoint_type = floatingpointT;
-    using mode_type = modeT;
-    using random_type = randomT;
-
-    random_type& rng;
+    using preference_type = preferenceT;
 
-    // Sparse matrix to store A and P values.
-    AP_type<floatingpoint_type> ap;
+    // Sparse matrix to store A values and the rows and columns accessors.
+    AP_type<preference_type> ap;
 
-    // Vector shared between all constraints to store the reduced cost.
-    bx::fixed_array<r_data<floatingpoint_type>> R;
-
-    // Vector for each constraint with negative coefficients.
-    bx::fixed_array<bx::fixed_array<c_data>> C;
+    // Negative coefficients of all the constraints in one block: entries of
+    // the constraint k are C[C_access[k]] to C[C_access[k + 1]].
+    bx::fixed_array<int> C_access;
+    bx::fixed_array<c_data> C;
 
     // Vector of boolean where true informs a Z coefficient in the equation or
     // inequation.
@@ -342,48 +497,39 @@ struct solver
 
     // Bound vector.
     b_type b;
-    const c_type<floatingpoint_type>& c;
-    x_type x;
-    pi_type<floatingpoint_type> pi;
+
+    // Bitmaps of the short constraints with only 1 coefficients.
+    row_bitmaps masks;
+
+    // Initial solution of the file init policy, empty otherwise.
+    x_type init;
+
+    // Upper bounds of the variables of the integer solver, the lower bounds
+    // are 0. Empty if all the variables are binary.
+    std::vector<int> U;
+
+    int rsizemax;
     int m;
     int n;
 
-    solver(random_type& rng_,
-           int n_,
-           const c_type<floatingpoint_type>& c_,
-           const std::vector<bx::itm::merged_constraint>& csts,
-           bx::itm::init_policy_type init_type,
-           double init_random)
-      : rng(rng_)
-      , ap(length(csts), n_)
-      , C(length(csts))
+    solver_structure(int n_,
+                     const std::vector<bx::itm::merged_constraint>& csts,
+                     const x_type& init_,
+                     std::vector<int> U_ = std::vector<int>())
+      : ap(length(csts), n_)
+      , C_access(length(csts) + 1, 0)
       , Z(length(csts), false)
       , b(length(csts))
-      , c(c_)
-      , x(n_)
-      , pi(length(csts))
+      , init(init_)
+      , U(std::move(U_))
+      , rsizemax(0)
       , m(length(csts))
       , n(n_)
     {
-        {
-            // Compute the number of elements in the matrix A then compute for
-            // each rows and columns the number of elements to correctly
-            // initialize the @c `matrix` structure.
-
-            bx::fixed_array<int> rinit(m, 0), cinit(n, 0);
-            int elem{ 0 };
-
-            for (int i{ 0 }, e{ length(csts) }; i != e; ++i) {
-                for (const auto& cst : csts[i].elements) {
-                    rinit[i]++;
-                    cinit[cst.variable_index]++;
-                    ++elem;
-                }
-            }
+        // Build the rows and the columns of the @c `matrix` structure in one
+        // pass, already sorted.
 
-            ap.reserve(
-              elem, rinit.begin(), rinit.end(), cinit.begin(), cinit.end());
-        }
+        ap.build(csts);
 
         {
             // Compute the minimal bounds for each constraints, default
@@ -395,13 +541,13 @@ struct solver
                 int lower = 0, upper = 0;
 
                 for (const auto& cst : csts[i].elements) {
-                    ap.set(i, cst.variable_index, cst.factor, 0.0);
+                    const int u = U.empty() ? 1 : U[cst.variable_index];
 
                     if (cst.factor > 0)
-                        upper += cst.factor;
+                        upper += cst.factor * u;
 
                     if (cst.factor < 0)
-                        lower += cst.factor;
+                        lower += cst.factor * u;
 
                     if (std::abs(cst.factor) > 1)
                         Z[i] = true;
@@ -427,17 +573,15 @@ struct solver
                     }
                 }
             }
-
-            ap.sort();
         }
 
         {
             //
             // Compute the R vector size and the C vectors for each constraints
-            // with negative coefficient.
+            // with negative coefficient. Solvers own their P matrix, the P
+            // of the shared matrix is released.
             //
 
-            int rsizemax = 0;
             for (int i = 0, e = length(csts); i != e; ++i) {
                 int rsize = 0, csize = 0;
 
@@ -448,32 +592,100 @@ struct solver
                 }
 
                 rsizemax = std::max(rsizemax, rsize);
+                C_access[i + 1] = C_access[i] + csize;
+            }
 
-                if (csize <= 0) // No negative coefficient found in
-                    continue;   // constraint, try the next.
+            C = bx::fixed_array<c_data>(C_access[length(csts)]);
 
-                C[i] = bx::fixed_array<c_data>(csize);
+            for (int i = 0, e = length(csts); i != e; ++i) {
+                // No negative coefficient found in constraint, try the next.
+                if (C_access[i] == C_access[i + 1])
+                    continue;
 
                 int id_in_r = 0;
-                int id_in_c = 0;
+                int id_in_c = C_access[i];
 
-                typename AP_type<floatingpoint_type>::const_iterator it, et;
+                typename AP_type<preferenceT>::const_iterator it, et;
                 std::tie(it, et) = ap.row(i);
 
                 for (; it != et; ++it) {
                     if (ap.A()[it->value] < 0) {
-                        C[i][id_in_c].id_r = id_in_r;
-                        C[i][id_in_c].id_A = it->position;
+                        C[id_in_c].id_r = id_in_r;
+                        C[id_in_c].id_A = it->position;
+                        C[id_in_c].id_P = it->value;
                         ++id_in_c;
                     }
                     ++id_in_r;
                 }
             }
 
-            R = bx::fixed_array<r_data<floatingpoint_type>>(rsizemax);
+            ap.P().clear();
+            ap.P().shrink_to_fit();
         }
 
-        reinit(x_type(), init_type, init_random);
+        if (U.empty())
+            masks.build(ap, m);
+    }
+};
+
+template<typename floatingpointT,
+         typename preferenceT,
+         typename modeT,
+         typename randomT>
+struct solver
+{
+    using floatingpoint_type = floatingpointT;
+    using preference_type = preferenceT;
+    using mode_type = modeT;
+    using random_type = randomT;
+    using solution_type = x_type;
+
+    random_type& rng;
+
+    // A and the accessors are read from the shared structure, P is private.
+    // P may use a smaller storage type than @c floatingpoint_type, its values
+    // are converted back to @c floatingpoint_type before any computation.
+    SharedAP_type<preference_type> ap;
+
+    // Vector shared between all constraints to store the reduced cost.
+    bx::fixed_array<r_data<floatingpoint_type>> R;
+
+    const bx::fixed_array<int>& C_access;
+    const bx::fixed_array<c_data>& C;
+    const std::vector<bool>& Z;
+    const b_type& b;
+    const row_bitmaps& masks;
+    const c_type<floatingpoint_type>& c;
+    x_type x;
+    pi_type<floatingpoint_type> pi;
+    int m;
+    int n;
+
+    solver(random_type& rng_,
+           const solver_structure<preference_type>& structure,
+           const c_type<floatingpoint_type>& c_,
+           bx::itm::init_policy_type init_type,
+           double init_random)
+      : rng(rng_)
+      , ap(structure.ap)
+      , R(structure.rsizemax)
+      , C_access(structure.C_access)
+      , C(structure.C)
+      , Z(structure.Z)
+      , b(structure.b)
+      , masks(structure.masks)
+      , c(c_)
+      , x(structure.n)
+      , pi(structure.m)
+      , m(structure.m)
+      , n(structure.n)
+    {
+        reinit(structure.init, init_type, init_random);
+    }
+
+    constexpr int upper(int) const noexcept
+    {
+        return 1;
     }
 
     void reinit(const x_type& best_previous,
@@ -486,6 +698,9 @@ struct solver
         if (best_previous.empty() and type == bx::itm::init_policy_type::best)
             type = bx::itm::init_policy_type::random;
 
+        if (best_previous.empty() and type == bx::itm::init_policy_type::file)
+            type = bx::itm::init_policy_type::bastert;
+
         init_random = bx::clamp(init_random, 0.0, 1.0);
 
         std::bernoulli_distribution d(init_random);
@@ -514,6 +729,9 @@ struct solver
                 if (d(rng))
                     x(i) = best_previous(i);
             break;
+        case bx::itm::init_policy_type::file:
+            x = best_previous;
+            break;
         }
     }
 
@@ -556,7 +774,7 @@ struct solver
     {
         bx::result ret;
 
-        if (is_valid_solution(ap, x, b)) {
+        if (is_valid_solution(ap, masks, x, b)) {
             ret.status = bx::result_status::success;
             double value = cost_constant;
 
@@ -584,13 +802,13 @@ struct solver
                                  floatingpoint_type theta,
                                  floatingpoint_type objective_amplifier)
     {
-        typename AP_type<floatingpoint_type>::const_iterator it, et;
+        typename AP_type<preference_type>::const_iterator it, et;
         std::tie(it, et) = ap.row(k);
 
         decrease_preference(it, et, theta);
 
-        const auto& ck = C[k];
-        const int c_size = length(ck);
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
         const int r_size = compute_reduced_costs(it, et);
         int bk_move = 0;
 
@@ -610,7 +828,7 @@ struct solver
 
         for (int i = 0; i != c_size; ++i) {
             R[ck[i].id_r].value = -R[ck[i].id_r].value;
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
             bk_move += ap.A()[ck[i].id_A];
         }
 
@@ -628,7 +846,7 @@ struct solver
         //
 
         for (int i = 0; i != c_size; ++i) {
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
             x[ck[i].id_A] = 1 - x[ck[i].id_A];
         }
     }
@@ -641,13 +859,13 @@ struct solver
                                    floatingpoint_type theta,
                                    floatingpoint_type objective_amplifier)
     {
-        typename AP_type<floatingpoint_type>::const_iterator it, et;
+        typename AP_type<preference_type>::const_iterator it, et;
         std::tie(it, et) = ap.row(k);
 
         decrease_preference(it, et, theta);
 
-        const auto& ck = C[k];
-        const int c_size = (ck) ? length(ck) : 0;
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
         const int r_size = compute_reduced_costs(it, et);
         int bk_move = 0;
 
@@ -667,7 +885,7 @@ struct solver
 
         for (int i = 0; i != c_size; ++i) {
             R[ck[i].id_r].value = -R[ck[i].id_r].value;
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
             bk_move += ap.A()[ck[i].id_A];
         }
 
@@ -686,7 +904,7 @@ struct solver
         //
 
         for (int i = 0; i != c_size; ++i) {
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
             x[ck[i].id_A] = 1 - x[ck[i].id_A];
         }
     }
@@ -698,7 +916,7 @@ struct solver
                                   floatingpoint_type theta,
                                   floatingpoint_type objective_amplifier)
     {
-        typename AP_type<floatingpoint_type>::const_iterator it, et;
+        typename AP_type<preference_type>::const_iterator it, et;
         std::tie(it, et) = ap.row(k);
 
         decrease_preference(it, et, theta);
@@ -729,7 +947,7 @@ struct solver
                                     floatingpoint_type theta,
                                     floatingpoint_type objective_amplifier)
     {
-        typename AP_type<floatingpoint_type>::const_iterator it, et;
+        typename AP_type<preference_type>::const_iterator it, et;
         std::tie(it, et) = ap.row(k);
 
         decrease_preference(it, et, theta);
@@ -759,13 +977,13 @@ struct solver
                                    floatingpoint_type theta,
                                    floatingpoint_type objective_amplifier)
     {
-        typename AP_type<floatingpoint_type>::const_iterator it, et;
+        typename AP_type<preference_type>::const_iterator it, et;
         std::tie(it, et) = ap.row(k);
 
         decrease_preference(it, et, theta);
 
-        const auto& ck = C[k];
-        const int c_size = length(ck);
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
         const int r_size = compute_reduced_costs(it, et);
 
         //
@@ -784,7 +1002,7 @@ struct solver
 
         for (int i = 0; i != c_size; ++i) {
             R[ck[i].id_r].value = -R[ck[i].id_r].value;
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
         }
 
         bk += c_size;
@@ -801,7 +1019,7 @@ struct solver
         //
 
         for (int i = 0; i != c_size; ++i) {
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
             x[ck[i].id_A] = 1 - x[ck[i].id_A];
         }
     }
@@ -814,13 +1032,13 @@ struct solver
                                      floatingpoint_type theta,
                                      floatingpoint_type objective_amplifier)
     {
-        typename AP_type<floatingpoint_type>::const_iterator it, et;
+        typename AP_type<preference_type>::const_iterator it, et;
         std::tie(it, et) = ap.row(k);
 
         decrease_preference(it, et, theta);
 
-        const auto& ck = C[k];
-        const int c_size = (ck) ? length(ck) : 0;
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
         const int r_size = compute_reduced_costs(it, et);
 
         //
@@ -839,7 +1057,7 @@ struct solver
 
         for (int i = 0; i != c_size; ++i) {
             R[ck[i].id_r].value = -R[ck[i].id_r].value;
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
         }
 
         bkmin += c_size;
@@ -857,7 +1075,7 @@ struct solver
         //
 
         for (int i = 0; i != c_size; ++i) {
-            ap.invert_p(k, ck[i].id_A);
+            ap.invert_p(ck[i].id_P);
             x[ck[i].id_A] = 1 - x[ck[i].id_A];
         }
     }
@@ -888,16 +1106,18 @@ struct solver
             floatingpoint_type sum_a_pi = 0;
             floatingpoint_type sum_a_p = 0;
 
-            typename AP_type<floatingpoint_type>::const_iterator ht, hend;
+            typename AP_type<preference_type>::const_iterator ht, hend;
             std::tie(ht, hend) = ap.column(begin->position);
 
             for (; ht != hend; ++ht) {
                 auto a = ap.A()[ht->value];
                 sum_a_pi += a * pi[ht->position];
-                sum_a_p += a * ap.P()[ht->value];
+                sum_a_p +=
+                  a * static_cast<floatingpoint_type>(ap.P()[ht->value]);
             }
 
             R[r_size].id = begin->position;
+            R[r_size].id_P = begin->value;
             R[r_size].value = c[begin->position] - sum_a_pi - sum_a_p;
             ++r_size;
         }
@@ -964,12 +1184,12 @@ struct solver
         if (selected < 0) {
             for (int i = 0; i != r_size; ++i) {
                 x(R[i].id) = 0;
-                ap.add_p(k, R[i].id, -delta);
+                ap.add_p(R[i].id_P, -delta);
             }
         } else if (selected + 1 >= r_size) {
             for (int i = 0; i != r_size; ++i) {
                 x(R[i].id) = 1;
-                ap.add_p(k, R[i].id, delta);
+                ap.add_p(R[i].id_P, delta);
             }
         } else {
             pi(k) += ((R[selected].value + R[selected + 1].value) / 2.0);
@@ -981,12 +1201,12 @@ struct solver
             int i = 0;
             for (; i <= selected; ++i) {
                 x(R[i].id) = 1;
-                ap.add_p(k, R[i].id, +d);
+                ap.add_p(R[i].id_P, +d);
             }
 
             for (; i != r_size; ++i) {
                 x(R[i].id) = 0;
-                ap.add_p(k, R[i].id, -d);
+                ap.add_p(R[i].id_P, -d);
             }
         }
     }
@@ -1004,7 +1224,7 @@ struct solver
             else
                 compute_update_row_Z_ineq(
                   k, b(k).min, b(k).max, kappa, delta, theta, obj_amp);
-        } else if (!C[k]) {
+        } else if (C_access[k] == C_access[k + 1]) {
             if (b(k).min == b(k).max)
                 compute_update_row_01_eq(
                   k, b(k).min, kappa, delta, theta, obj_amp);
@@ -1032,7 +1252,7 @@ struct solver
             else
                 compute_update_row_Z_ineq(
                   k, b(k).min, b(k).max, kappa, delta, theta, 0);
-        } else if (!C[k]) {
+        } else if (C_access[k] == C_access[k + 1]) {
             if (b(k).min == b(k).max)
                 compute_update_row_01_eq(k, b(k).min, kappa, delta, theta, 0);
             else
@@ -1048,116 +1268,471 @@ struct solver
     }
 };
 
-// #ifndef BARYONYX_FULL_OPTIMIZATION
-// template <typename floatingpointT>
-// static void
-// print_AP(std::shared_ptr<bx::context> ctx,
-//          const AP_type<floatingpointT>& ap,
-//          int k,
-//          int rows,
-//          int cols)
-// {
-//     int level = ctx->get_integer_parameter("print-level", 0l);
-//     if (level <= 1)
-//         return;
-
-//     debug(ctx,"P after constraint {} computation:\n", k);
-//     std::vector<floatingpointT> to_show(cols);
-
-//     for (int i{ 0 }; i != rows; ++i) {
-//         std::fill(std::begin(to_show),
-//                   std::end(to_show),
-//                   std::numeric_limits<floatingpointT>::infinity());
-
-//         auto its = ap.row(i);
-
-//         for (; std::get<0>(its) != std::get<1>(its); ++std::get<0>(its))
-//             to_show[std::get<0>(its)->position] =
-//               ap.P()[std::get<0>(its)->value];
-
-//         for (auto elem : to_show)
-//             if (elem == std::numeric_limits<floatingpointT>::infinity())
-//                 debug(ctx,"          ");
-//             else
-//                 debug(ctx,"%+.6f ", (double)elem);
-
-//         debug(ctx,"\n");
-//     }
-// }
-
 //
-// Compute a problem lower or upper bounds based on Lagrangian multipliers
-// (valid if there are equality constraints only?)
+// The solver of the problems with general integer variables. The variable j
+// takes a value in [0, U[j]], the lower bounds are moved into the
+// constraints before the solve. The row subproblem is a bounded
+// multiple-choice selection: each variable of the row takes a number of
+// units, the units of a variable share its reduced cost. The rows with -1
+// and 1 coefficients are solved greedily on the sorted reduced costs, the
+// other rows with the bounded knapsack dynamic programming. The preference
+// of a variable increases if all its units are selected, decreases if none
+// is selected and does not move if the variable is at the split of the row.
 //
-template<typename floatingpointT, typename modeT>
-struct bounds_printer
+template<typename floatingpointT,
+         typename preferenceT,
+         typename modeT,
+         typename randomT>
+struct integer_solver
 {
-    floatingpointT bestlb;
-    floatingpointT bestub;
-    floatingpointT max_cost;
+    using floatingpoint_type = floatingpointT;
+    using preference_type = preferenceT;
+    using mode_type = modeT;
+    using random_type = randomT;
+    using solution_type = bx::fixed_array<int>;
 
-    static floatingpointT max_cost_init(const c_type<floatingpointT>& c,
-                                        bx::minimize_tag) noexcept
-    {
-        assert(not c.empty());
+    random_type& rng;
 
-        return *std::max_element(c.cbegin(), c.cend());
-    }
+    SharedAP_type<preference_type> ap;
 
-    static floatingpointT max_cost_init(const c_type<floatingpointT>& c,
-                                        bx::maximize_tag) noexcept
-    {
-        assert(not c.empty());
+    // Vector shared between all constraints to store the reduced cost and
+    // the units selected for each reduced cost.
+    bx::fixed_array<r_data<floatingpoint_type>> R;
+    bx::fixed_array<int> V;
+
+    const bx::fixed_array<int>& C_access;
+    const bx::fixed_array<c_data>& C;
+    const std::vector<bool>& Z;
+    const b_type& b;
+    const row_bitmaps& masks;
+    const std::vector<int>& U;
+    const c_type<floatingpoint_type>& c;
+    solution_type x;
+    pi_type<floatingpoint_type> pi;
+    int m;
+    int n;
 
-        return *std::min_element(c.cbegin(), c.cend());
+    integer_solver(random_type& rng_,
+                   const solver_structure<preference_type>& structure,
+                   const c_type<floatingpoint_type>& c_,
+                   bx::itm::init_policy_type init_type,
+                   double init_random)
+      : rng(rng_)
+      , ap(structure.ap)
+      , R(structure.rsizemax)
+      , V(structure.rsizemax)
+      , C_access(structure.C_access)
+      , C(structure.C)
+      , Z(structure.Z)
+      , b(structure.b)
+      , masks(structure.masks)
+      , U(structure.U)
+      , c(c_)
+      , x(structure.n, 0)
+      , pi(structure.m)
+      , m(structure.m)
+      , n(structure.n)
+    {
+        reinit(solution_type(), init_type, init_random);
     }
 
-    bounds_printer(const c_type<floatingpointT>& c)
-      : bestlb(std::numeric_limits<floatingpointT>::lowest())
-      , bestub(std::numeric_limits<floatingpointT>::max())
-      , max_cost(max_cost_init(c, modeT()))
-    {}
-
-    template<typename randomT>
-    floatingpointT init_bound(
-      const solver<floatingpointT, modeT, randomT>& slv,
-      bx::minimize_tag)
+    int upper(int j) const noexcept
     {
-        floatingpointT b{ 0 };
-
-        for (auto c = 0; c != slv.m; ++c)
-            b += slv.pi[c] * slv.b(c).min;
-
-        return b;
+        return U[j];
     }
 
-    template<typename randomT>
-    floatingpointT init_bound(
-      const solver<floatingpointT, modeT, randomT>& slv,
-      bx::maximize_tag)
+    void reinit(const solution_type& best_previous,
+                bx::itm::init_policy_type type,
+                double init_random)
     {
-        floatingpointT b{ 0 };
+        std::fill(ap.P().begin(), ap.P().end(), 0);
+        std::fill(pi.begin(), pi.end(), 0);
 
-        for (auto c = 0; c != slv.m; ++c)
-            b += slv.pi[c] * slv.b(c).max;
+        if (best_previous.empty() and
+            (type == bx::itm::init_policy_type::best or
+             type == bx::itm::init_policy_type::file))
+            type = bx::itm::init_policy_type::bastert;
 
-        return b;
-    }
+        init_random = bx::clamp(init_random, 0.0, 1.0);
 
-    template<typename randomT>
-    floatingpointT add_bound(const solver<floatingpointT, modeT, randomT>& slv,
-                             int j,
-                             floatingpointT sum_a_pi,
-                             bx::minimize_tag)
-    {
-        if (slv.c[j] - sum_a_pi < 0)
-            return slv.c[j] - sum_a_pi;
+        std::bernoulli_distribution d(init_random);
+
+        switch (type) {
+        case bx::itm::init_policy_type::bastert:
+            if (init_random == 0.0 or init_random == 1.0) {
+                bool value_if_cost_0 = init_random == 1.0;
+
+                for (int i = 0; i != n; ++i)
+                    x(i) = init_x(c(i), value_if_cost_0, mode_type()) ? U[i]
+                                                                      : 0;
+            } else {
+                for (int i = 0; i != n; ++i)
+                    x(i) = init_x(c(i), d(rng), mode_type()) ? U[i] : 0;
+            }
+            break;
+        case bx::itm::init_policy_type::random:
+            for (int i = 0; i != n; ++i) {
+                std::binomial_distribution<int> units(U[i], init_random);
+                x(i) = units(rng);
+            }
+            break;
+        case bx::itm::init_policy_type::best:
+            for (int i = 0; i != n; ++i) {
+                std::binomial_distribution<int> units(U[i], init_random);
+                x(i) = d(rng) ? best_previous(i) : units(rng);
+            }
+            break;
+        case bx::itm::init_policy_type::file:
+            x = best_previous;
+            break;
+        }
+    }
+
+    void print(const std::shared_ptr<bx::context>& ctx,
+               const std::vector<std::string>& names,
+               int print_level) const
+    {
+        if (print_level <= 0)
+            return;
+
+        debug(ctx, "  - X: {} to {}\n", 0, length(x));
+        for (int i = 0, e = length(x); i != e; ++i)
+            debug(ctx, "    - {} {}={}/c_i:{}\n", i, names[i], x[i], c[i]);
+        debug(ctx, "\n");
+
+        for (int k = 0, ek = m; k != ek; ++k) {
+            const int v = masks.value(ap, x, k);
+
+            bool valid = b(k).min <= v and v <= b(k).max;
+            debug(ctx,
+                  "C {}:{} (Lmult: {})\n",
+                  k,
+                  (valid ? "   valid" : "violated"),
+                  pi[k]);
+        }
+    }
+
+    bx::result results(const c_type<floatingpoint_type>& original_costs,
+                       const double cost_constant) const
+    {
+        bx::result ret;
+
+        if (is_valid_solution(ap, masks, x, b)) {
+            ret.status = bx::result_status::success;
+            double value = cost_constant;
+
+            for (int i{ 0 }, ei{ n }; i != ei; ++i)
+                value += original_costs[i] * x[i];
+
+            ret.value = static_cast<double>(value);
+        }
+
+        ret.variable_value.assign(x.begin(), x.end());
+        ret.variables = n;
+        ret.constraints = m;
+
+        return ret;
+    }
+
+    void compute_update_row(int k,
+                            floatingpoint_type kappa,
+                            floatingpoint_type delta,
+                            floatingpoint_type theta,
+                            floatingpoint_type objective_amplifier = 0)
+    {
+        typename AP_type<preference_type>::const_iterator it, et;
+        std::tie(it, et) = ap.row(k);
+
+        decrease_preference(it, et, theta);
+
+        const c_data* ck = C.data() + C_access[k];
+        const int c_size = C_access[k + 1] - C_access[k];
+        const int r_size = compute_reduced_costs(it, et);
+        int bkmin = b(k).min;
+        int bkmax = b(k).max;
+
+        if (objective_amplifier)
+            for (int i = 0; i != r_size; ++i)
+                R[i].value += objective_amplifier * c[R[i].id];
+
+        //
+        // Negate reduced costs and coefficients of these variables: the
+        // variable x in [0, U] is replaced by U - x.
+        //
+
+        for (int i = 0; i != c_size; ++i) {
+            R[ck[i].id_r].value = -R[ck[i].id_r].value;
+            ap.invert_p(ck[i].id_P);
+            bkmin -= ap.A()[ck[i].id_P] * U[ck[i].id_A];
+            bkmax -= ap.A()[ck[i].id_P] * U[ck[i].id_A];
+        }
+
+        if (Z[k])
+            select_variables_knapsack(r_size, bkmin, bkmax);
+        else
+            select_variables_greedy(r_size, bkmin, bkmax);
+
+        affect_variables(k, r_size, kappa, delta);
+
+        //
+        // Clean up: correct negated costs and adjust value of negated
+        // variables.
+        //
+
+        for (int i = 0; i != c_size; ++i) {
+            ap.invert_p(ck[i].id_P);
+            x[ck[i].id_A] = U[ck[i].id_A] - x[ck[i].id_A];
+        }
+    }
+
+    void push_and_compute_update_row(int k,
+                                     floatingpoint_type kappa,
+                                     floatingpoint_type delta,
+                                     floatingpoint_type theta,
+                                     floatingpoint_type obj_amp)
+    {
+        compute_update_row(k, kappa, delta, theta, obj_amp);
+    }
+
+    template<typename iteratorT>
+    void decrease_preference(iteratorT begin,
+                             iteratorT end,
+                             floatingpoint_type theta) noexcept
+    {
+        for (; begin != end; ++begin)
+            ap.P()[begin->value] *= theta;
+    }
+
+    template<typename iteratorT>
+    int compute_reduced_costs(iteratorT begin, iteratorT end) noexcept
+    {
+        int r_size = 0;
+
+        for (; begin != end; ++begin) {
+            floatingpoint_type sum_a_pi = 0;
+            floatingpoint_type sum_a_p = 0;
+
+            typename AP_type<preference_type>::const_iterator ht, hend;
+            std::tie(ht, hend) = ap.column(begin->position);
+
+            for (; ht != hend; ++ht) {
+                auto a = ap.A()[ht->value];
+                sum_a_pi += a * pi[ht->position];
+                sum_a_p +=
+                  a * static_cast<floatingpoint_type>(ap.P()[ht->value]);
+            }
+
+            R[r_size].id = begin->position;
+            R[r_size].id_P = begin->value;
+            R[r_size].value = c[begin->position] - sum_a_pi - sum_a_p;
+            ++r_size;
+        }
+
+        return r_size;
+    }
+
+    //
+    // The units needed to reach bkmin are taken first in the order of the
+    // reduced costs, then the units with an improving reduced cost until
+    // bkmax.
+    //
+    void select_variables_greedy(const int r_size, int bkmin, int bkmax)
+    {
+        calculator_sort(R.begin(), R.begin() + r_size, rng, mode_type());
+
+        int i = 0;
+        int sum = 0;
+
+        for (; i != r_size; ++i) {
+            const int u = U[R[i].id];
+            int units = std::min(u, std::max(0, bkmin - sum));
+
+            if (units < u and sum + units < bkmax and
+                not stop_iterating(R[i].value, rng, mode_type()))
+                units = std::min(u, bkmax - sum);
+
+            V[i] = units;
+            sum += units;
+
+            if (units < u) {
+                ++i;
+                break;
+            }
+        }
+
+        for (; i != r_size; ++i)
+            V[i] = 0;
+    }
+
+    void select_variables_knapsack(const int r_size, int bkmin, int bkmax)
+    {
+        int sum = 0;
+        for (int i = 0; i != r_size; ++i)
+            sum += std::abs(ap.A()[R[i].id_P]) * U[R[i].id];
+
+        bkmax = bx::clamp(bkmax, 0, sum);
+
+        if (baryonyx::bounded_knapsack_dp_solver<modeT, floatingpoint_type>(
+              ap, R, U, V, r_size, bkmin, bkmax) < 0) {
+            assert(false && "b(k) can not be reached, this is an error of "
+                            "the preprocessing step.");
+
+            for (int i = 0; i != r_size; ++i)
+                V[i] = 0;
+        }
+    }
+
+    //
+    // The Lagrangian multiplier moves to the middle of the worst selected
+    // unit and of the best unselected unit.
+    //
+    void affect_variables(int k,
+                          int r_size,
+                          const floatingpointT kappa,
+                          const floatingpointT delta) noexcept
+    {
+        int in = -1, out = -1;
+
+        for (int i = 0; i != r_size; ++i) {
+            if (V[i] > 0 and
+                (in < 0 or
+                 is_better_solution(R[in].value, R[i].value, mode_type())))
+                in = i;
+
+            if (V[i] < U[R[i].id] and
+                (out < 0 or
+                 is_better_solution(R[i].value, R[out].value, mode_type())))
+                out = i;
+        }
+
+        floatingpoint_type d = delta;
+
+        if (in >= 0 and out >= 0) {
+            pi(k) += ((R[in].value + R[out].value) / 2.0);
+
+            d += ((kappa / (1.0 - kappa)) * (R[out].value - R[in].value));
+        }
+
+        for (int i = 0; i != r_size; ++i) {
+            x(R[i].id) = V[i];
+
+            if (U[R[i].id] == 0)
+                continue;
+
+            if (V[i] == U[R[i].id])
+                ap.add_p(R[i].id_P, +d);
+            else if (V[i] == 0)
+                ap.add_p(R[i].id_P, -d);
+        }
+    }
+};
+
+// #ifndef BARYONYX_FULL_OPTIMIZATION
+// template <typename floatingpointT>
+// static void
+// print_AP(std::shared_ptr<bx::context> ctx,
+//          const AP_type<floatingpointT>& ap,
+//          int k,
+//          int rows,
+//          int cols)
+// {
+//     int level = ctx->get_integer_parameter("print-level", 0l);
+//     if (level <= 1)
+//         return;
+
+//     debug(ctx,"P after constraint {} computation:\n", k);
+//     std::vector<floatingpointT> to_show(cols);
+
+//     for (int i{ 0 }; i != rows; ++i) {
+//         std::fill(std::begin(to_show),
+//                   std::end(to_show),
+//                   std::numeric_limits<floatingpointT>::infinity());
+
+//         auto its = ap.row(i);
+
+//         for (; std::get<0>(its) != std::get<1>(its); ++std::get<0>(its))
+//             to_show[std::get<0>(its)->position] =
+//               ap.P()[std::get<0>(its)->value];
+
+//         for (auto elem : to_show)
+//             if (elem == std::numeric_limits<floatingpointT>::infinity())
+//                 debug(ctx,"          ");
+//             else
+//                 debug(ctx,"%+.6f ", (double)elem);
+
+//         debug(ctx,"\n");
+//     }
+// }
+
+//
+// Compute a problem lower or upper bounds based on Lagrangian multipliers
+// (valid if there are equality constraints only?)
+//
+template<typename floatingpointT, typename modeT>
+struct bounds_printer
+{
+    floatingpointT bestlb;
+    floatingpointT bestub;
+    floatingpointT max_cost;
+
+    static floatingpointT max_cost_init(const c_type<floatingpointT>& c,
+                                        bx::minimize_tag) noexcept
+    {
+        assert(not c.empty());
+
+        return *std::max_element(c.cbegin(), c.cend());
+    }
+
+    static floatingpointT max_cost_init(const c_type<floatingpointT>& c,
+                                        bx::maximize_tag) noexcept
+    {
+        assert(not c.empty());
+
+        return *std::min_element(c.cbegin(), c.cend());
+    }
+
+    bounds_printer(const c_type<floatingpointT>& c)
+      : bestlb(std::numeric_limits<floatingpointT>::lowest())
+      , bestub(std::numeric_limits<floatingpointT>::max())
+      , max_cost(max_cost_init(c, modeT()))
+    {}
+
+    template<typename solverT>
+    floatingpointT init_bound(const solverT& slv, bx::minimize_tag)
+    {
+        floatingpointT b{ 0 };
+
+        for (auto c = 0; c != slv.m; ++c)
+            b += slv.pi[c] * slv.b(c).min;
+
+        return b;
+    }
+
+    template<typename solverT>
+    floatingpointT init_bound(const solverT& slv, bx::maximize_tag)
+    {
+        floatingpointT b{ 0 };
+
+        for (auto c = 0; c != slv.m; ++c)
+            b += slv.pi[c] * slv.b(c).max;
+
+        return b;
+    }
+
+    template<typename solverT>
+    floatingpointT add_bound(const solverT& slv,
+                             int j,
+                             floatingpointT sum_a_pi,
+                             bx::minimize_tag)
+    {
+        if (slv.c[j] - sum_a_pi < 0)
+            return slv.c[j] - sum_a_pi;
 
         return { 0 };
     }
 
-    template<typename randomT>
-    floatingpointT add_bound(const solver<floatingpointT, modeT, randomT>& slv,
+    template<typename solverT>
+    floatingpointT add_bound(const solverT& slv,
                              int j,
                              floatingpointT sum_a_pi,
                              bx::maximize_tag)
@@ -1226,8 +1801,8 @@ struct bounds_printer
         return std::numeric_limits<floatingpointT>::lowest();
     }
 
-    template<typename randomT>
-    void operator()(const solver<floatingpointT, modeT, randomT>& slv,
+    template<typename solverT>
+    void operator()(const solverT& slv,
                     const std::shared_ptr<bx::context>& ctx,
                     const bx::result& best)
     {
@@ -1240,7 +1815,7 @@ struct bounds_printer
         for (auto j = 0; j != slv.n; ++j) {
             floatingpointT sum_a_pi = 0.;
 
-            typename AP_type<floatingpointT>::const_iterator ht, hend;
+            typename std::decay_t<decltype(slv.ap)>::const_iterator ht, hend;
             std::tie(ht, hend) = slv.ap.column(j);
 
             for (; ht != hend; ++ht) {
@@ -1248,7 +1823,7 @@ struct bounds_printer
                 sum_a_pi += std::abs(a) * slv.pi[ht->position];
             }
 
-            lb += add_bound(slv, j, sum_a_pi, modeT());
+            lb += add_bound(slv, j, sum_a_pi, modeT()) * slv.upper(j);
         }
 
         lb *= max_cost; // restore original cost
@@ -1257,20 +1832,112 @@ struct bounds_printer
     }
 };
 
+//
+// Lazy row activation of the constraint orders. Between two full checks,
+// only the active rows are checked after an iteration: the rows violated or
+// with a slack lower than @c margin at the last full check. All the rows are
+// checked every @c period iterations and when no active row is violated, so
+// a feasible solution is always confirmed on all the rows. The slack of a
+// bound the row can not reach (e.g. the lower bound of a less constraint) is
+// ignored. With a null @c period, all the rows are checked after each
+// iteration.
+//
+struct lazy_rows
+{
+    std::vector<int> active;
+    std::vector<int> lower;
+    std::vector<int> upper;
+    int period;
+    int margin;
+    int iteration = 0;
+
+    template<typename solverT>
+    lazy_rows(const std::shared_ptr<bx::context>& ctx, const solverT& s)
+      : period(ctx->get_integer_parameter("active-set-period", 0))
+      , margin(std::max(0, ctx->get_integer_parameter("active-set-margin", 1)))
+    {
+        if (period <= 0)
+            return;
+
+        lower.resize(s.m, 0);
+        upper.resize(s.m, 0);
+
+        typename std::decay_t<decltype(s.ap)>::const_iterator it, et;
+        const auto& va = s.ap.A();
+
+        for (int k = 0; k != s.m; ++k)
+            for (std::tie(it, et) = s.ap.row(k); it != et; ++it)
+                if (va[it->value] < 0)
+                    lower[k] += va[it->value] * s.upper(it->position);
+                else
+                    upper[k] += va[it->value] * s.upper(it->position);
+    }
+
+    template<typename solverT, typename C>
+    int refresh(const solverT& s, C& r)
+    {
+        if (period <= 0)
+            return compute_missing_constraint(s.ap, s.masks, s.x, s.b, r);
+
+        iteration = 0;
+        active.clear();
+        r.clear();
+
+        for (int k = 0; k != s.m; ++k) {
+            const int v = s.masks.value(s.ap, s.x, k);
+
+            if (not(s.b(k).min <= v and v <= s.b(k).max)) {
+                r.emplace_back(k);
+                active.emplace_back(k);
+            } else if ((s.b(k).min > lower[k] and v - s.b(k).min <= margin) or
+                       (s.b(k).max < upper[k] and s.b(k).max - v <= margin)) {
+                active.emplace_back(k);
+            }
+        }
+
+        return length(r);
+    }
+
+    template<typename solverT, typename C>
+    int missing(const solverT& s, C& r)
+    {
+        if (period <= 0)
+            return compute_missing_constraint(s.ap, s.masks, s.x, s.b, r);
+
+        if (++iteration < period) {
+            r.clear();
+
+            for (auto k : active) {
+                const int v = s.masks.value(s.ap, s.x, k);
+
+                if (not(s.b(k).min <= v and v <= s.b(k).max))
+                    r.emplace_back(k);
+            }
+
+            if (not r.empty())
+                return length(r);
+        }
+
+        return refresh(s, r);
+    }
+};
+
 template<typename floatingpointT, typename randomT>
 struct compute_none
 {
     using random_type = randomT;
 
     std::shared_ptr<bx::context> m_ctx;
+    lazy_rows rows;
     std::vector<int> R;
 
     template<typename solverT>
     compute_none(std::shared_ptr<bx::context> ctx, const solverT& s, randomT&)
       : m_ctx(std::move(ctx))
+      , rows(m_ctx, s)
       , R(s.m)
     {
-        compute_missing_constraint(s.ap, s.x, s.b, R);
+        rows.refresh(s, R);
     }
 
     template<typename solverT>
@@ -1278,25 +1945,28 @@ struct compute_none
                      floatingpointT kappa,
                      floatingpointT delta,
                      floatingpointT theta,
-                     floatingpointT objective_amplifier)
+                     floatingpointT objective_amplifier,
+                     bx::stop_poller& stop)
     {
-        for (int k = 0, e = solver.m; k != e; ++k)
+        for (int k = 0, e = solver.m; k != e and not stop.poll(); ++k)
             solver.push_and_compute_update_row(
               k, kappa, delta, theta, objective_amplifier);
 
-        return compute_missing_constraint(solver.ap, solver.x, solver.b, R);
+        return rows.refresh(solver, R);
     }
 
     template<typename solverT>
     int run(solverT& solver,
             floatingpointT kappa,
             floatingpointT delta,
-            floatingpointT theta)
+            floatingpointT theta,
+            bx::stop_poller& stop)
     {
-        for (auto it = R.begin(), et = R.end(); it != et; ++it)
+        for (auto it = R.begin(), et = R.end(); it != et and not stop.poll();
+             ++it)
             solver.compute_update_row(*it, kappa, delta, theta);
 
-        return compute_missing_constraint(solver.ap, solver.x, solver.b, R);
+        return rows.missing(solver, R);
     }
 };
 
@@ -1306,15 +1976,17 @@ struct compute_reversing
     using random_type = randomT;
 
     std::shared_ptr<bx::context> m_ctx;
+    lazy_rows rows;
     std::vector<int> R;
     int nb = 0;
 
     template<typename solverT>
     compute_reversing(std::shared_ptr<bx::context> ctx, solverT& s, randomT&)
       : m_ctx(std::move(ctx))
+      , rows(m_ctx, s)
       , R(s.m)
     {
-        compute_missing_constraint(s.ap, s.x, s.b, R);
+        rows.refresh(s, R);
     }
 
     template<typename solverT>
@@ -1322,25 +1994,28 @@ struct compute_reversing
                      floatingpointT kappa,
                      floatingpointT delta,
                      floatingpointT theta,
-                     floatingpointT objective_amplifier)
+                     floatingpointT objective_amplifier,
+                     bx::stop_poller& stop)
     {
-        for (int k = 0, e = solver.m; k != e; ++k)
+        for (int k = 0, e = solver.m; k != e and not stop.poll(); ++k)
             solver.push_and_compute_update_row(
               k, kappa, delta, theta, objective_amplifier);
 
-        return compute_missing_constraint(solver.ap, solver.x, solver.b, R);
+        return rows.refresh(solver, R);
     }
 
     template<typename solverT>
     int run(solverT& solver,
             floatingpointT kappa,
             floatingpointT delta,
-            floatingpointT theta)
+            floatingpointT theta,
+            bx::stop_poller& stop)
     {
-        for (auto it = R.rbegin(), et = R.rend(); it != et; ++it)
+        for (auto it = R.rbegin(), et = R.rend(); it != et and not stop.poll();
+             ++it)
             solver.compute_update_row(*it, kappa, delta, theta);
 
-        return compute_missing_constraint(solver.ap, solver.x, solver.b, R);
+        return rows.missing(solver, R);
     }
 };
 
@@ -1350,6 +2025,7 @@ struct compute_random
     using random_type = randomT;
 
     std::shared_ptr<bx::context> m_ctx;
+    lazy_rows rows;
     std::vector<int> R;
     random_type& rng;
 
@@ -1358,10 +2034,11 @@ struct compute_random
                    solverT& s,
                    random_type& rng_)
       : m_ctx(std::move(ctx))
+      , rows(m_ctx, s)
       , R(s.m)
       , rng(rng_)
     {
-        compute_missing_constraint(s.ap, s.x, s.b, R);
+        rows.refresh(s, R);
     }
 
     template<typename solverT>
@@ -1369,27 +2046,30 @@ struct compute_random
                      floatingpointT kappa,
                      floatingpointT delta,
                      floatingpointT theta,
-                     floatingpointT objective_amplifier)
+                     floatingpointT objective_amplifier,
+                     bx::stop_poller& stop)
     {
-        for (int k = 0, e = solver.m; k != e; ++k)
+        for (int k = 0, e = solver.m; k != e and not stop.poll(); ++k)
             solver.push_and_compute_update_row(
               k, kappa, delta, theta, objective_amplifier);
 
-        return compute_missing_constraint(solver.ap, solver.x, solver.b, R);
+        return rows.refresh(solver, R);
     }
 
     template<typename solverT>
     int run(solverT& solver,
             floatingpointT kappa,
             floatingpointT delta,
-            floatingpointT theta)
+            floatingpointT theta,
+            bx::stop_poller& stop)
     {
         std::shuffle(R.begin(), R.end(), rng);
 
-        for (auto it = R.begin(), et = R.end(); it != et; ++it)
+        for (auto it = R.begin(), et = R.end(); it != et and not stop.poll();
+             ++it)
             solver.compute_update_row(*it, kappa, delta, theta);
 
-        return compute_missing_constraint(solver.ap, solver.x, solver.b, R);
+        return rows.missing(solver, R);
     }
 };
 
@@ -1444,12 +2124,7 @@ struct compute_infeasibility
         R.clear();
 
         for (int k = 0, e = solver.m; k != e; ++k) {
-            auto ak{ solver.ap.row(k) };
-            int v = 0;
-
-            for (; std::get<0>(ak) != std::get<1>(ak); ++std::get<0>(ak))
-                v += solver.ap.A()[std::get<0>(ak)->value] *
-                     solver.x(std::get<0>(ak)->position);
+            const int v = solver.masks.value(solver.ap, solver.x, k);
 
             if (solver.b(k).min > v)
                 R.push_back(std::make_pair(k, solver.b(k).min - v));
@@ -1465,9 +2140,10 @@ struct compute_infeasibility
                      floatingpointT kappa,
                      floatingpointT delta,
                      floatingpointT theta,
-                     floatingpointT objective_amplifier)
+                     floatingpointT objective_amplifier,
+                     bx::stop_poller& stop)
     {
-        for (int k = 0, e = solver.m; k != e; ++k)
+        for (int k = 0, e = solver.m; k != e and not stop.poll(); ++k)
             solver.push_and_compute_update_row(
               k, kappa, delta, theta, objective_amplifier);
 
@@ -1478,52 +2154,205 @@ struct compute_infeasibility
     int run(solverT& solver,
             floatingpointT kappa,
             floatingpointT delta,
-            floatingpointT theta)
+            floatingpointT theta,
+            bx::stop_poller& stop)
     {
         ::sort(R.begin(), R.end(), direction_type());
 
-        for (auto it = R.begin(), et = R.end(); it != et; ++it)
+        for (auto it = R.begin(), et = R.end(); it != et and not stop.poll();
+             ++it)
             solver.compute_update_row(it->first, kappa, delta, theta);
 
         return local_compute_missing_constraint(solver);
     }
 };
 
+//
+// The portfolio constraint order stores all the constraint orders and
+// switches between them when the optimizer thread changes its configuration.
+//
+template<typename floatingpointT, typename randomT>
+struct compute_portfolio
+{
+    using random_type = randomT;
+
+    compute_none<floatingpointT, randomT> none;
+    compute_reversing<floatingpointT, randomT> reversing;
+    compute_random<floatingpointT, randomT> random;
+    compute_infeasibility<floatingpointT, randomT, compute_infeasibility_decr>
+      infeasibility_decr;
+    compute_infeasibility<floatingpointT, randomT, compute_infeasibility_incr>
+      infeasibility_incr;
+    bx::itm::constraint_order order = bx::itm::constraint_order::none;
+
+    template<typename solverT>
+    compute_portfolio(std::shared_ptr<bx::context> ctx,
+                      solverT& s,
+                      random_type& rng)
+      : none(ctx, s, rng)
+      , reversing(ctx, s, rng)
+      , random(ctx, s, rng)
+      , infeasibility_decr(ctx, s, rng)
+      , infeasibility_incr(ctx, s, rng)
+    {}
+
+    template<typename solverT>
+    void assign(solverT& solver, bx::itm::constraint_order order_)
+    {
+        order = order_;
+
+        switch (order) {
+        case bx::itm::constraint_order::none:
+            none.rows.refresh(solver, none.R);
+            break;
+        case bx::itm::constraint_order::reversing:
+            reversing.rows.refresh(solver, reversing.R);
+            break;
+        case bx::itm::constraint_order::random_sorting:
+            random.rows.refresh(solver, random.R);
+            break;
+        case bx::itm::constraint_order::infeasibility_decr:
+            infeasibility_decr.local_compute_missing_constraint(solver);
+            break;
+        case bx::itm::constraint_order::infeasibility_incr:
+            infeasibility_incr.local_compute_missing_constraint(solver);
+            break;
+        }
+    }
+
+    template<typename solverT>
+    int push_and_run(solverT& solver,
+                     floatingpointT kappa,
+                     floatingpointT delta,
+                     floatingpointT theta,
+                     floatingpointT objective_amplifier,
+                     bx::stop_poller& stop)
+    {
+        switch (order) {
+        case bx::itm::constraint_order::reversing:
+            return reversing.push_and_run(
+              solver, kappa, delta, theta, objective_amplifier, stop);
+        case bx::itm::constraint_order::random_sorting:
+            return random.push_and_run(
+              solver, kappa, delta, theta, objective_amplifier, stop);
+        case bx::itm::constraint_order::infeasibility_decr:
+            return infeasibility_decr.push_and_run(
+              solver, kappa, delta, theta, objective_amplifier, stop);
+        case bx::itm::constraint_order::infeasibility_incr:
+            return infeasibility_incr.push_and_run(
+              solver, kappa, delta, theta, objective_amplifier, stop);
+        default:
+            return none.push_and_run(
+              solver, kappa, delta, theta, objective_amplifier, stop);
+        }
+    }
+
+    template<typename solverT>
+    int run(solverT& solver,
+            floatingpointT kappa,
+            floatingpointT delta,
+            floatingpointT theta,
+            bx::stop_poller& stop)
+    {
+        switch (order) {
+        case bx::itm::constraint_order::reversing:
+            return reversing.run(solver, kappa, delta, theta, stop);
+        case bx::itm::constraint_order::random_sorting:
+            return random.run(solver, kappa, delta, theta, stop);
+        case bx::itm::constraint_order::infeasibility_decr:
+            return infeasibility_decr.run(solver, kappa, delta, theta, stop);
+        case bx::itm::constraint_order::infeasibility_incr:
+            return infeasibility_incr.run(solver, kappa, delta, theta, stop);
+        default:
+            return none.run(solver, kappa, delta, theta, stop);
+        }
+    }
+};
+
+template<typename computeT, typename solverT>
+static inline void
+assign_constraint_order(computeT&, solverT&, bx::itm::constraint_order)
+{}
+
+template<typename floatingpointT, typename randomT, typename solverT>
+static inline void
+assign_constraint_order(compute_portfolio<floatingpointT, randomT>& compute,
+                        solverT& solver,
+                        bx::itm::constraint_order order)
+{
+    compute.assign(solver, order);
+}
+
+//
+// The state shared by the threads of a race: the flag which stops all the
+// solvers and the identifier of the first thread with a feasible solution.
+//
+struct race_state
+{
+    std::atomic<bool> found{ false };
+    std::atomic<int> winner{ -1 };
+};
+
 template<typename floatingpointT,
+         typename preferenceT,
          typename modeT,
          typename constraintOrderT,
-         typename randomT>
+         typename randomT,
+         typename solverT = solver<floatingpointT, preferenceT, modeT, randomT>>
 struct solver_functor
 {
     using floatingpoint_type = floatingpointT;
+    using preference_type = preferenceT;
     using mode_type = modeT;
     using constraint_order_type = constraintOrderT;
     using random_type = randomT;
+    using solver_type = solverT;
 
     std::chrono::time_point<std::chrono::steady_clock> m_begin;
     std::chrono::time_point<std::chrono::steady_clock> m_end;
 
     std::shared_ptr<bx::context> m_ctx;
     randomT& m_rng;
+    std::mutex& m_progress_mutex;
     const std::vector<std::string>& m_variable_names;
     const bx::affected_variables& m_affected_vars;
+    const bx::itm::renumbering& m_renumber;
 
-    x_type m_best_x;
+    // The component of a decomposed problem, its progress is merged with the
+    // progress of the other components and it does not write temp.sol.
+    const bx::itm::progress_component* m_component;
+
+    // In race mode, the state shared by the solvers of the race and the
+    // identifier of this solver. The first solver with a feasible solution
+    // claims the victory and stops the others.
+    race_state* m_race;
+    int m_race_id;
+
+    typename solver_type::solution_type m_best_x;
     bx::result m_best;
 
     solver_functor(std::shared_ptr<bx::context> ctx,
                    randomT& rng,
+                   std::mutex& progress_mutex,
                    const std::vector<std::string>& variable_names,
-                   const bx::affected_variables& affected_vars)
+                   const bx::affected_variables& affected_vars,
+                   const bx::itm::renumbering& renumber,
+                   const bx::itm::progress_component* component = nullptr,
+                   race_state* race = nullptr,
+                   int race_id = 0)
       : m_ctx(std::move(ctx))
       , m_rng(rng)
+      , m_progress_mutex(progress_mutex)
       , m_variable_names(variable_names)
       , m_affected_vars(affected_vars)
+      , m_renumber(renumber)
+      , m_component(component)
+      , m_race(race)
+      , m_race_id(race_id)
     {}
 
     bx::result operator()(
-      const std::vector<bx::itm::merged_constraint>& constraints,
-      int variables,
+      const solver_structure<preference_type>& structure,
       const c_type<floatingpointT>& original_costs,
       const c_type<floatingpointT>& norm_costs,
       double cost_constant,
@@ -1536,23 +2365,29 @@ struct solver_functor
         int pushed = -1;
         int best_remaining = -1;
         int pushing_iteration = p.pushing_iteration_limit;
-        floatingpoint_type kappa = p.kappa_min;
+        bx::itm::kappa_controller<floatingpoint_type> kappa_ctl(p);
+        floatingpoint_type kappa = kappa_ctl.kappa();
 
-        solver<floatingpoint_type, mode_type, random_type> slv(m_rng,
-                                                               variables,
-                                                               norm_costs,
-                                                               constraints,
-                                                               p.init_policy,
-                                                               p.init_random);
+        solver_type slv(
+          m_rng, structure, norm_costs, p.init_policy, p.init_random);
 
         constraint_order_type compute(m_ctx, slv, m_rng);
 
         bounds_printer<floatingpointT, modeT> bound_print(original_costs);
 
+        bx::stop_poller stop(*m_ctx, m_race ? &m_race->found : nullptr);
+
+        bx::itm::progress_reporter progress(m_ctx,
+                                            m_progress_mutex,
+                                            0,
+                                            p.progress_period,
+                                            &m_renumber,
+                                            m_component);
+
         info(m_ctx, "* solver starts:\n");
 
         for (;;) {
-            int remaining = compute.run(slv, kappa, p.delta, p.theta);
+            int remaining = compute.run(slv, kappa, p.delta, p.theta, stop);
 
             if (best_remaining == -1 or remaining < best_remaining) {
                 best_remaining = remaining;
@@ -1563,6 +2398,8 @@ struct solver_functor
                   std::chrono::duration_cast<std::chrono::duration<double>>(
                     m_end - m_begin)
                     .count();
+                m_best_x = slv.x;
+                progress.improve(m_best.value, remaining, m_best.duration);
 
                 bound_print(slv, m_ctx, m_best);
 
@@ -1574,6 +2411,14 @@ struct solver_functor
                      i);
             }
 
+            if (m_race and remaining == 0) {
+                int expected = -1;
+                m_race->winner.compare_exchange_strong(expected, m_race_id);
+                m_race->found.store(true);
+                progress.flush(m_end, m_best_x, true);
+                return m_best;
+            }
+
 #ifndef BARYONYX_FULL_OPTIMIZATION
             slv.print(m_ctx, m_variable_names, p.print_level);
 #endif
@@ -1600,7 +2445,8 @@ struct solver_functor
                                            p.pushing_k_factor * kappa,
                                            p.delta,
                                            p.theta,
-                                           p.pushing_objective_amplifier);
+                                           p.pushing_objective_amplifier,
+                                           stop);
 
                     if (remaining == 0) {
                         auto current =
@@ -1608,8 +2454,10 @@ struct solver_functor
                         current.loop = i;
                         current.remaining_constraints = 0;
 
-                        if (store_if_better(current))
+                        if (store_if_better(current)) {
                             m_best_x = slv.x;
+                            progress.improve(m_best.value, 0, m_best.duration);
+                        }
                     }
                 }
 
@@ -1618,20 +2466,33 @@ struct solver_functor
                       m_ctx,
                       "    - Push system limit reached. Solution found: {}\n",
                       m_best.value);
+                    progress.flush(m_end, m_best_x, true);
                     return m_best;
                 }
             }
 
-            if (i > p.w)
-                kappa += p.kappa_step *
-                         std::pow(static_cast<floatingpointT>(remaining) /
-                                    static_cast<floatingpointT>(slv.m),
-                                  p.alpha);
+            kappa = kappa_ctl.update(i, remaining, slv.m);
 
             if (++i > p.limit) {
                 info(m_ctx, "  - Loop limit reached: {}\n", i);
                 if (pushed == -1)
-                    m_best.status = bx::result_status::limit_reached;
+                    m_best.status = bx::result_status::limit_reached;
+
+                if (m_ctx->get_integer_parameter("print-level", 0) > 0)
+                    print_missing_constraint(m_ctx,
+                                             slv.ap,
+                                             m_best.variable_value,
+                                             slv.b,
+                                             m_variable_names);
+
+                progress.flush(m_end, m_best_x, true);
+                return m_best;
+            }
+
+            if (kappa_ctl.exhausted()) {
+                info(m_ctx, "  - Kappa max reached: {:+.6f}\n", kappa);
+                if (pushed == -1)
+                    m_best.status = bx::result_status::kappa_max_reached;
 
                 if (m_ctx->get_integer_parameter("print-level", 0) > 0)
                     print_missing_constraint(m_ctx,
@@ -1640,13 +2501,17 @@ struct solver_functor
                                              slv.b,
                                              m_variable_names);
 
+                progress.flush(m_end, m_best_x, true);
                 return m_best;
             }
 
-            if (kappa > p.kappa_max) {
-                info(m_ctx, "  - Kappa max reached: {:+.6f}\n", kappa);
+            m_end = std::chrono::steady_clock::now();
+            progress.flush(m_end, m_best_x);
+
+            if (bx::is_time_limit(p.time_limit, m_begin, m_end)) {
+                info(m_ctx, "  - Time limit reached: {} {:+.6f}\n", i, kappa);
                 if (pushed == -1)
-                    m_best.status = bx::result_status::kappa_max_reached;
+                    m_best.status = bx::result_status::time_limit_reached;
 
                 if (m_ctx->get_integer_parameter("print-level", 0) > 0)
                     print_missing_constraint(m_ctx,
@@ -1655,12 +2520,15 @@ struct solver_functor
                                              slv.b,
                                              m_variable_names);
 
+                progress.flush(m_end, m_best_x, true);
                 return m_best;
             }
 
-            m_end = std::chrono::steady_clock::now();
-            if (bx::is_time_limit(p.time_limit, m_begin, m_end)) {
-                info(m_ctx, "  - Time limit reached: {} {:+.6f}\n", i, kappa);
+            if (stop.poll(m_end)) {
+                info(m_ctx,
+                     "  - Stop or deadline reached: {} {:+.6f}\n",
+                     i,
+                     kappa);
                 if (pushed == -1)
                     m_best.status = bx::result_status::time_limit_reached;
 
@@ -1671,6 +2539,7 @@ struct solver_functor
                                              slv.b,
                                              m_variable_names);
 
+                progress.flush(m_end, m_best_x, true);
                 return m_best;
             }
         }
@@ -1699,18 +2568,17 @@ private:
             m_best = current;
             m_best.duration = t;
 
-            std::ofstream ofs("temp.sol");
-            ofs << m_best;
-
-            std::size_t i, e;
+            if (m_component)
+                return true;
 
-            for (i = 0, e = m_affected_vars.names.size(); i != e; ++i)
-                ofs << m_affected_vars.names[i] << ':'
-                    << m_affected_vars.values[i] << '\n';
-
-            for (i = 0, e = m_variable_names.size(); i != e; ++i)
-                ofs << m_variable_names[i] << ':' << m_best.variable_value[i]
-                    << '\n';
+            std::ofstream ofs("temp.sol", std::ios::binary);
+            baryonyx_private::write_result(
+              ofs,
+              m_best,
+              m_variable_names,
+              m_affected_vars,
+              baryonyx_private::get_result_format(m_ctx),
+              baryonyx_private::get_result_sparse(m_ctx));
 
             return true;
         }
@@ -1719,94 +2587,260 @@ private:
     }
 };
 
+//
+// The loop state of an optimizer thread, saved in its checkpoints.
+//
+struct optimizer_state
+{
+    double elapsed;
+    int loop;
+    int pushed;
+    int pushing_iteration;
+    int configuration;
+    int slice_remaining;
+    double slice_value;
+};
+
+//
+// The checkpoint of an optimizer thread: the loop state, the kappa
+// controller, the random generator, P, pi and x of the solver and the best
+// solution of the thread.
+//
+template<typename floatingpointT, typename preferenceT>
+struct thread_checkpoint
+{
+    using kappa_type = bx::itm::kappa_controller<floatingpointT>;
+    using word_type = bx::bit_array::word_type;
+
+    static_assert(std::is_trivially_copyable<kappa_type>::value,
+                  "The kappa controller is saved as raw bytes.");
+
+    optimizer_state state;
+    unsigned char kappa[sizeof(kappa_type)];
+    std::string rng;
+    std::vector<preferenceT> P;
+    std::vector<floatingpointT> pi;
+    std::vector<word_type> x;
+    std::vector<word_type> best_x;
+    std::vector<int> best_values;
+    double best_value;
+    double best_duration;
+    int best_loop;
+    int best_remaining;
+    bx::result_status best_status;
+
+    bool read(bx::checkpoint_reader& in)
+    {
+        return in.read(state) and in.read(kappa) and in.read(rng) and
+               in.read(P) and in.read(pi) and in.read(x) and
+               in.read(best_x) and in.read(best_values) and
+               in.read(best_value) and in.read(best_duration) and
+               in.read(best_loop) and in.read(best_remaining) and
+               in.read(best_status);
+    }
+};
+
 template<typename floatingpointT,
+         typename preferenceT,
          typename modeT,
          typename constraintOrderT,
-         typename randomT>
+         typename randomT,
+         typename solverT = solver<floatingpointT, preferenceT, modeT, randomT>>
 struct optimize_functor
 {
     using floatingpoint_type = floatingpointT;
+    using preference_type = preferenceT;
     using mode_type = modeT;
     using constraint_order_type = constraintOrderT;
     using random_type = randomT;
+    using solver_type = solverT;
+
+    // The checkpoints and the local search work on the bit array of the
+    // binary solver only.
+    using binary_solver =
+      std::is_same<typename solver_type::solution_type, x_type>;
 
     std::chrono::time_point<std::chrono::steady_clock> m_begin;
     std::chrono::time_point<std::chrono::steady_clock> m_end;
 
+    using portfolio_costs_type =
+      std::unordered_map<std::string, c_type<floatingpointT>>;
+
     std::shared_ptr<bx::context> m_ctx;
     randomT m_rng;
     int m_thread_id;
+    std::mutex& m_progress_mutex;
+    bx::itm::portfolio* m_portfolio;
+    const portfolio_costs_type* m_portfolio_costs;
     const std::vector<std::string>& m_variable_names;
     const bx::affected_variables& m_affected_vars;
-    x_type m_best_x;
+    const bx::itm::renumbering& m_renumber;
+    const bx::checkpoint& m_checkpoint;
+    typename solver_type::solution_type m_best_x;
     bx::result m_best;
 
     optimize_functor(std::shared_ptr<bx::context> ctx,
                      int thread_id,
                      typename random_type::result_type seed,
+                     std::mutex& progress_mutex,
+                     bx::itm::portfolio* portfolio,
+                     const portfolio_costs_type* portfolio_costs,
                      const std::vector<std::string>& variable_names,
-                     const bx::affected_variables& affected_vars)
+                     const bx::affected_variables& affected_vars,
+                     const bx::itm::renumbering& renumber,
+                     const bx::checkpoint& checkpoint)
       : m_ctx(std::move(ctx))
       , m_rng(seed)
       , m_thread_id(thread_id)
+      , m_progress_mutex(progress_mutex)
+      , m_portfolio(portfolio)
+      , m_portfolio_costs(portfolio_costs)
       , m_variable_names(variable_names)
       , m_affected_vars(affected_vars)
+      , m_renumber(renumber)
+      , m_checkpoint(checkpoint)
     {}
 
     bx::result operator()(
-      const std::vector<bx::itm::merged_constraint>& constraints,
-      int variables,
+      const solver_structure<preference_type>& structure,
       const c_type<floatingpointT>& original_costs,
       const c_type<floatingpointT>& norm_costs,
       double cost_constant,
-      const bx::itm::parameters& p)
+      const bx::itm::parameters& global)
     {
         m_begin = std::chrono::steady_clock::now();
         m_end = m_begin;
 
+        thread_checkpoint<floatingpoint_type, preference_type> saved;
+        bool resume = load_checkpoint(saved);
+
+        // With a portfolio, the thread uses its own copy of the parameters
+        // and of the normalized costs and replaces them at each restart.
+
+        bx::itm::parameters p = global;
+        c_type<floatingpointT> costs;
+        int configuration = -1;
+
+        if (m_portfolio) {
+            configuration = m_portfolio->assign(
+              m_thread_id, resume ? saved.state.configuration : -1);
+            p = m_portfolio->configuration(configuration);
+            costs = m_portfolio_costs->at(p.norm);
+        }
+
         int i = 0;
         int pushed = -1;
         int pushing_iteration = 0;
-        floatingpoint_type kappa = p.kappa_min;
+        bx::itm::kappa_controller<floatingpoint_type> kappa_ctl(p);
+        floatingpoint_type kappa = kappa_ctl.kappa();
+
+        // Best result of the current configuration since the last restart.
+        int slice_remaining = std::numeric_limits<int>::max();
+        double slice_value = 0.0;
+
+        solver_type slv(m_rng,
+                        structure,
+                        m_portfolio ? costs : norm_costs,
+                        p.init_policy,
+                        p.init_random);
+
+        if (resume and
+            restore_checkpoint(saved, slv, kappa_ctl, binary_solver())) {
+            i = saved.state.loop;
+            pushed = saved.state.pushed;
+            pushing_iteration = saved.state.pushing_iteration;
+            slice_remaining = saved.state.slice_remaining;
+            slice_value = saved.state.slice_value;
+            kappa = kappa_ctl.kappa();
+
+            m_begin -= std::chrono::duration_cast<
+              std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(saved.state.elapsed));
+        }
 
-        solver<floatingpoint_type, mode_type, random_type> slv(m_rng,
-                                                               variables,
-                                                               norm_costs,
-                                                               constraints,
-                                                               p.init_policy,
-                                                               p.init_random);
+        auto next_checkpoint = m_end + m_checkpoint.period();
 
         constraint_order_type compute(m_ctx, slv, m_rng);
+        assign_constraint_order(compute, slv, p.order);
+
+        bx::details::local_search<mode_type, floatingpoint_type> polisher(
+          slv.m, slv.n);
 
         bounds_printer<floatingpointT, modeT> bound_print(original_costs);
 
-        for (; not bx::is_time_limit(p.time_limit, m_begin, m_end);
+        bx::stop_poller stop(*m_ctx);
+
+        bx::itm::progress_reporter progress(m_ctx,
+                                            m_progress_mutex,
+                                            m_thread_id,
+                                            p.progress_period,
+                                            &m_renumber);
+
+        for (; not bx::is_time_limit(p.time_limit, m_begin, m_end) and
+               not stop.poll(m_end);
              m_end = std::chrono::steady_clock::now(), ++i) {
 
-            int remaining = compute.run(slv, kappa, p.delta, p.theta);
+            int remaining = compute.run(slv, kappa, p.delta, p.theta, stop);
 
             if (remaining == 0) {
                 auto current = slv.results(original_costs, cost_constant);
                 current.loop = i;
                 current.remaining_constraints = remaining;
+
+                if (slice_remaining > 0 or
+                    is_better_solution(current.value, slice_value, modeT()))
+                    slice_value = current.value;
+
                 if (store_if_better(current)) {
+                    polish(slv, polisher, p, original_costs, cost_constant, i);
                     m_best_x = slv.x;
+                    progress.improve(m_best.value, 0, m_best.duration);
                     pushed = 0;
                 }
             }
 
-            if (i > p.w)
-                kappa +=
-                  p.kappa_step * std::pow(static_cast<double>(remaining) /
-                                            static_cast<double>(slv.m),
-                                          p.alpha);
+            slice_remaining = std::min(slice_remaining, remaining);
+
+            if (stop.stopped())
+                break;
+
+            kappa = kappa_ctl.update(i, remaining, slv.m);
 
-            if (i >= p.limit or kappa > p.kappa_max or
+            if (i >= p.limit or kappa_ctl.restart() or
                 pushed > p.pushes_limit) {
-                slv.reinit(m_best_x, p.init_policy, p.init_random);
+                if (m_portfolio) {
+                    auto next = m_portfolio->next(
+                      configuration, slice_remaining, slice_value);
+
+                    if (next != configuration) {
+                        debug(m_ctx,
+                              "  - thread {} switches to configuration {}\n",
+                              m_thread_id,
+                              next);
+
+                        configuration = next;
+                        p = m_portfolio->configuration(configuration);
+                        costs = m_portfolio_costs->at(p.norm);
+                        kappa_ctl.assign(p);
+                    }
+
+                    slice_remaining = std::numeric_limits<int>::max();
+                    slice_value = 0.0;
+                }
+
+                // The solution file only starts the solver, the restarts
+                // mix the best solution as the best policy.
+
+                slv.reinit(m_best_x,
+                           p.init_policy == bx::itm::init_policy_type::file
+                             ? bx::itm::init_policy_type::best
+                             : p.init_policy,
+                           p.init_random);
+                assign_constraint_order(compute, slv, p.order);
 
                 i = 0;
-                kappa = p.kappa_min;
+                kappa_ctl.reset();
+                kappa = kappa_ctl.kappa();
                 pushed = -1;
                 pushing_iteration = 0;
 
@@ -1825,7 +2859,8 @@ struct optimize_functor
                                            p.pushing_k_factor * kappa,
                                            p.delta,
                                            p.theta,
-                                           p.pushing_objective_amplifier);
+                                           p.pushing_objective_amplifier,
+                                           stop);
 
                     if (remaining == 0) {
                         auto current =
@@ -1833,19 +2868,259 @@ struct optimize_functor
                         current.loop = i;
                         current.remaining_constraints = 0;
 
-                        if (store_if_better(current))
+                        if (slice_remaining > 0 or
+                            is_better_solution(
+                              current.value, slice_value, modeT()))
+                            slice_value = current.value;
+                        slice_remaining = 0;
+
+                        if (store_if_better(current)) {
+                            polish(slv,
+                                   polisher,
+                                   p,
+                                   original_costs,
+                                   cost_constant,
+                                   i);
                             m_best_x = slv.x;
+                            progress.improve(m_best.value, 0, m_best.duration);
+                        }
                     }
                 }
             }
 
             bound_print(slv, m_ctx, m_best);
+            progress.flush(m_end, m_best_x);
+
+            if (m_checkpoint.write() and m_end >= next_checkpoint) {
+                next_checkpoint = m_end + m_checkpoint.period();
+
+                save_checkpoint(slv,
+                                kappa_ctl,
+                                { duration(), i + 1, pushed,
+                                  pushing_iteration, configuration,
+                                  slice_remaining, slice_value },
+                                binary_solver());
+            }
         }
 
+        // The time limit, a stop request or a signal ends the loop: the
+        // last checkpoint keeps all the work done. The current loop may have
+        // been interrupted, the resumed thread starts it again.
+
+        if (m_checkpoint.write())
+            save_checkpoint(slv,
+                            kappa_ctl,
+                            { duration(), i, pushed, pushing_iteration,
+                              configuration, slice_remaining, slice_value },
+                            binary_solver());
+
+        progress.flush(std::chrono::steady_clock::now(), m_best_x, true);
+
         return m_best;
     }
 
 private:
+    double duration() const noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(
+                 m_end - m_begin)
+          .count();
+    }
+
+    //
+    // Reads the checkpoint of the thread to resume. The checkpoint is
+    // ignored if it does not exist or if it was written for another
+    // problem: the thread starts from scratch.
+    //
+    bool load_checkpoint(
+      thread_checkpoint<floatingpoint_type, preference_type>& saved)
+    {
+        if (not m_checkpoint.resume())
+            return false;
+
+        bx::checkpoint_reader in(m_checkpoint, m_thread_id);
+
+        if (in)
+            saved.read(in);
+
+        if (not in) {
+            warning(m_ctx,
+                    "  - thread {}: checkpoint {} ignored ({})\n",
+                    m_thread_id,
+                    m_checkpoint.resume_filename(m_thread_id),
+                    in.error());
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename kappaT>
+    bool restore_checkpoint(
+      const thread_checkpoint<floatingpoint_type, preference_type>&,
+      solver_type&,
+      kappaT&,
+      std::false_type)
+    {
+        warning(m_ctx,
+                "  - thread {}: checkpoint ignored (integer solver)\n",
+                m_thread_id);
+        return false;
+    }
+
+    template<typename kappaT>
+    bool restore_checkpoint(
+      const thread_checkpoint<floatingpoint_type, preference_type>& saved,
+      solver_type& slv,
+      kappaT& kappa_ctl,
+      std::true_type)
+    {
+        const auto words = x_type::words(slv.n);
+
+        if (saved.P.size() != slv.ap.P().size() or
+            saved.pi.size() != slv.pi.size() or saved.x.size() != words or
+            not(saved.best_x.empty() or saved.best_x.size() == words)) {
+            warning(m_ctx,
+                    "  - thread {}: checkpoint ignored (different size)\n",
+                    m_thread_id);
+            return false;
+        }
+
+        std::copy(saved.P.begin(), saved.P.end(), slv.ap.P().begin());
+        std::copy(saved.pi.begin(), saved.pi.end(), slv.pi.begin());
+        std::copy(saved.x.begin(), saved.x.end(), slv.x.data());
+
+        if (not saved.best_x.empty()) {
+            x_type best(slv.n);
+            std::copy(saved.best_x.begin(), saved.best_x.end(), best.data());
+            m_best_x.swap(best);
+        }
+
+        m_best.status = saved.best_status;
+        m_best.value = saved.best_value;
+        m_best.duration = saved.best_duration;
+        m_best.loop = saved.best_loop;
+        m_best.remaining_constraints = saved.best_remaining;
+        m_best.variable_value = saved.best_values;
+        m_best.variables = slv.n;
+        m_best.constraints = slv.m;
+
+        std::memcpy(&kappa_ctl, saved.kappa, sizeof(saved.kappa));
+
+        std::istringstream is(saved.rng);
+        is >> m_rng;
+
+        info(m_ctx,
+             "  - thread {}: resumes at loop {} ({:.10g}s)\n",
+             m_thread_id,
+             saved.state.loop,
+             saved.state.elapsed);
+
+        return true;
+    }
+
+    //
+    // Writes the checkpoint of the thread. The previous checkpoint is kept
+    // if the write fails.
+    //
+    template<typename kappaT>
+    void save_checkpoint(const solver_type&,
+                         const kappaT&,
+                         const optimizer_state&,
+                         std::false_type)
+    {}
+
+    template<typename kappaT>
+    void save_checkpoint(const solver_type& slv,
+                         const kappaT& kappa_ctl,
+                         const optimizer_state& state,
+                         std::true_type)
+    {
+        std::ostringstream rng;
+        rng << m_rng;
+
+        bx::checkpoint_writer out(m_checkpoint, m_thread_id);
+        out.write(state);
+        out.write(kappa_ctl);
+        out.write(rng.str());
+        out.write(slv.ap.P().data(), slv.ap.P().size());
+        out.write(slv.pi.data(), slv.pi.size());
+        out.write(slv.x.data(), x_type::words(slv.x.size()));
+        out.write(m_best_x.data(), x_type::words(m_best_x.size()));
+        out.write(m_best.variable_value.data(), m_best.variable_value.size());
+        out.write(m_best.value);
+        out.write(m_best.duration);
+        out.write(m_best.loop);
+        out.write(m_best.remaining_constraints);
+        out.write(m_best.status);
+
+        if (not out.commit())
+            warning(m_ctx,
+                    "  - thread {}: fail to write checkpoint {}\n",
+                    m_thread_id,
+                    m_checkpoint.filename(m_thread_id));
+    }
+
+    //
+    // Polishes the new incumbent of the solver with the local search and
+    // stores the polished solution if it improves the objective.
+    //
+    template<typename localSearchT>
+    void polish(solver_type& slv,
+                localSearchT& polisher,
+                const bx::itm::parameters& p,
+                const c_type<floatingpointT>& original_costs,
+                double cost_constant,
+                int loop)
+    {
+        polish(slv,
+               polisher,
+               p,
+               original_costs,
+               cost_constant,
+               loop,
+               binary_solver());
+    }
+
+    template<typename localSearchT>
+    void polish(solver_type&,
+                localSearchT&,
+                const bx::itm::parameters&,
+                const c_type<floatingpointT>&,
+                double,
+                int,
+                std::false_type)
+    {}
+
+    template<typename localSearchT>
+    void polish(solver_type& slv,
+                localSearchT& polisher,
+                const bx::itm::parameters& p,
+                const c_type<floatingpointT>& original_costs,
+                double cost_constant,
+                int loop,
+                std::true_type)
+    {
+        if (p.local_search == bx::itm::local_search_type::none)
+            return;
+
+        if (not polisher.run(slv.ap,
+                             slv.b,
+                             slv.x,
+                             original_costs,
+                             p.local_search_limit,
+                             p.local_search_tabu,
+                             p.local_search ==
+                               bx::itm::local_search_type::swap))
+            return;
+
+        auto current = slv.results(original_costs, cost_constant);
+        current.loop = loop;
+        current.remaining_constraints = 0;
+
+        store_if_better(current);
+    }
+
     bool store_if_better(const bx::result& current) noexcept
     {
         if (current.status != bx::result_status::success)
@@ -1869,18 +3144,15 @@ private:
             m_best = current;
             m_best.duration = t;
 
-            std::ofstream ofs(fmt::format("temp-{}.sol", m_thread_id));
-            ofs << m_best;
-
-            std::size_t i, e;
-
-            for (i = 0, e = m_affected_vars.names.size(); i != e; ++i)
-                ofs << m_affected_vars.names[i] << ':'
-                    << m_affected_vars.values[i] << '\n';
-
-            for (i = 0, e = m_variable_names.size(); i != e; ++i)
-                ofs << m_variable_names[i] << ':' << m_best.variable_value[i]
-                    << '\n';
+            std::ofstream ofs(fmt::format("temp-{}.sol", m_thread_id),
+                              std::ios::binary);
+            baryonyx_private::write_result(
+              ofs,
+              m_best,
+              m_variable_names,
+              m_affected_vars,
+              baryonyx_private::get_result_format(m_ctx),
+              baryonyx_private::get_result_sparse(m_ctx));
 
             return true;
         }
@@ -2017,14 +3289,261 @@ make_objective_function(const bx::objective_function& obj, int n)
     return ret;
 }
 
+//
+// Upper bounds of the variables for the integer solver, empty if all the
+// variables are binary.
+//
+static std::vector<int>
+make_upper_bounds(const bx::variables& vars)
+{
+    std::vector<int> ret;
+
+    if (std::none_of(
+          vars.values.cbegin(), vars.values.cend(), [](const auto& elem) {
+              return elem.type == bx::variable_type::general;
+          }))
+        return ret;
+
+    ret.reserve(vars.values.size());
+    for (const auto& elem : vars.values)
+        ret.emplace_back(elem.max);
+
+    return ret;
+}
+
+//
+// Hash of the preprocessed problem and of the types of the solver: a
+// checkpoint of the optimizer is only resumed for the same problem.
+//
+template<typename floatingpointT, typename preferenceT, typename modeT>
+static std::uint64_t
+problem_hash(const solver_structure<preferenceT>& structure,
+             const c_type<floatingpointT>& cost,
+             const std::vector<std::string>& names)
+{
+    bx::hasher h;
+
+    h.add(sizeof(floatingpointT));
+    h.add(sizeof(preferenceT));
+    h.add(std::is_same<modeT, bx::minimize_tag>::value);
+    h.add(structure.m);
+    h.add(structure.n);
+
+    typename AP_type<preferenceT>::const_iterator it, et;
+
+    for (int k = 0; k != structure.m; ++k) {
+        h.add(structure.b(k).min);
+        h.add(structure.b(k).max);
+
+        for (std::tie(it, et) = structure.ap.row(k); it != et; ++it) {
+            h.add(it->position);
+            h.add(structure.ap.A()[it->value]);
+        }
+    }
+
+    for (int i = 0; i != structure.n; ++i)
+        h.add(static_cast<double>(cost(i)));
+
+    for (const auto& name : names)
+        h.add(name);
+
+    return h.value();
+}
+
+//
+// Reads the solution of the @c init-solution parameter for the file init
+// policy and assigns it to the variables of the solver by name: @c names
+// are the names of the variables in the order of the solver, after the
+// preprocessing and the renumbering. Variables missing in the solution start
+// at 0. An empty vector is returned if the policy is not file or if the
+// solution can not be read, the solver then uses the bastert policy.
+//
+static x_type
+load_init_solution(const std::shared_ptr<bx::context>& ctx,
+                   const bx::itm::parameters& p,
+                   const std::vector<std::string>& names)
+{
+    if (p.init_policy != bx::itm::init_policy_type::file)
+        return x_type();
+
+    const auto filename = ctx->get_string_parameter("init-solution", "");
+    bx::result r;
+
+    try {
+        r = bx::make_result(ctx, filename);
+    } catch (const std::exception&) {
+        warning(ctx, "  - init-solution: fail to read {}\n", filename);
+        return x_type();
+    }
+
+    if (r.variable_name.empty()) {
+        warning(ctx, "  - init-solution: no variable in {}\n", filename);
+        return x_type();
+    }
+
+    std::unordered_map<std::string, int> values;
+
+    for (std::size_t i = 0, e = r.variable_name.size(); i != e; ++i)
+        values.emplace(r.variable_name[i], r.variable_value[i]);
+
+    for (std::size_t i = 0, e = r.affected_vars.names.size(); i != e; ++i)
+        values.emplace(r.affected_vars.names[i], r.affected_vars.values[i]);
+
+    x_type x(length(names));
+    int found = 0;
+
+    for (int i = 0, e = length(names); i != e; ++i) {
+        auto it = values.find(names[i]);
+
+        if (it != values.end()) {
+            x(i) = it->second != 0;
+            ++found;
+        }
+    }
+
+    info(ctx,
+         "  - init-solution: {}/{} variables read from {}\n",
+         found,
+         length(names),
+         filename);
+
+    return x;
+}
+
+//
+// Race mode of the solver: one solver per thread, each with its own seed and
+// the parameters of a configuration of the portfolio (the thread i uses the
+// configuration i modulo the size of the portfolio, the first built-in
+// configuration is the parameters of the solve). The first thread keeps the
+// seed of the solve. The first solver to find a feasible solution stops the
+// others. The constraint order is the order of the solve for all the
+// threads, a run of the race is reproduced by a solve with its seed and its
+// configuration.
+//
+template<typename floatingpointT,
+         typename preferenceT,
+         typename modeT,
+         typename constraintOrderT,
+         typename randomT,
+         typename solverT>
+static bx::result
+race(const std::shared_ptr<bx::context>& ctx,
+     const solver_structure<preferenceT>& structure,
+     const c_type<floatingpointT>& cost,
+     double cost_constant,
+     const bx::itm::parameters& p,
+     int seed,
+     int thread,
+     const std::vector<std::string>& names,
+     const bx::affected_variables& affected_vars,
+     const bx::itm::renumbering& renumber,
+     std::mutex& progress_mutex,
+     const bx::itm::progress_component* component)
+{
+    info(ctx, "Solver races with {} threads\n", thread);
+
+    const bx::itm::portfolio configurations(
+      ctx,
+      p,
+      std::is_same<modeT, bx::minimize_tag>::value,
+      static_cast<unsigned>(seed));
+
+    std::vector<int> seeds(thread, seed);
+    {
+        std::mt19937 gen(static_cast<unsigned>(seed));
+        std::uniform_int_distribution<int> dst(
+          0, std::numeric_limits<int>::max());
+
+        for (int i = 1; i != thread; ++i)
+            seeds[i] = dst(gen);
+    }
+
+    race_state state;
+    std::vector<std::thread> pool;
+    std::vector<std::future<bx::result>> results;
+
+    for (int i = 0; i != thread; ++i) {
+        std::packaged_task<bx::result()> task([&, i]() {
+            const auto& config =
+              configurations.configuration(i % configurations.size());
+
+            randomT rng(seeds[i]);
+            auto norm_costs = normalize_costs(ctx, config.norm, cost, rng);
+
+            solver_functor<floatingpointT,
+                           preferenceT,
+                           modeT,
+                           constraintOrderT,
+                           randomT,
+                           solverT>
+              slv(ctx,
+                  rng,
+                  progress_mutex,
+                  names,
+                  affected_vars,
+                  renumber,
+                  component,
+                  &state,
+                  i);
+
+            auto ret = slv(structure, cost, norm_costs, cost_constant, config);
+            ret.seed = seeds[i];
+
+            return ret;
+        });
+
+        results.emplace_back(task.get_future());
+        pool.emplace_back(std::move(task));
+    }
+
+    for (auto& t : pool)
+        t.join();
+
+    // Without feasible solution, the result of the race is the solution
+    // with the fewest remaining constraints.
+
+    std::vector<bx::result> ret;
+    for (auto& elem : results)
+        ret.emplace_back(elem.get());
+
+    int best = state.winner.load();
+    if (best < 0) {
+        best = 0;
+        for (int i = 1; i != thread; ++i)
+            if (ret[i].remaining_constraints <
+                ret[best].remaining_constraints)
+                best = i;
+    } else {
+        info(ctx,
+             "  - race won by thread {} (seed {}, configuration #{})\n",
+             best,
+             seeds[best],
+             best % configurations.size());
+    }
+
+    ret[best].method =
+      fmt::format("inequalities_Zcoeff solver (race: thread {}/{}, "
+                  "configuration #{})",
+                  best,
+                  thread,
+                  best % configurations.size());
+
+    return std::move(ret[best]);
+}
+
 template<typename floatingpointT,
+         typename preferenceT,
          typename modeT,
          typename constraintOrderT,
-         typename randomT>
+         typename randomT,
+         typename solverT =
+           solver<floatingpointT, preferenceT, modeT, randomT>>
 static bx::result
 solve(std::shared_ptr<bx::context> ctx,
       bx::problem& pb,
-      const bx::itm::parameters& p)
+      const bx::itm::parameters& p,
+      int thread,
+      const bx::itm::progress_component* component)
 {
     info(ctx, "Solver initializing\n");
 
@@ -2033,28 +3552,85 @@ solve(std::shared_ptr<bx::context> ctx,
 
     auto constraints{ bx::itm::make_merged_constraints(ctx, pb, p) };
     if (not constraints.empty() and not pb.vars.values.empty()) {
-        randomT rng(ctx->get_integer_parameter(
+        const int seed = ctx->get_integer_parameter(
           "seed",
-          std::chrono::system_clock::now().time_since_epoch().count()));
+          std::chrono::system_clock::now().time_since_epoch().count());
+        randomT rng(seed);
 
         auto variables = bx::numeric_cast<int>(pb.vars.values.size());
+        const bx::itm::renumbering renumber(ctx, constraints, variables);
         auto cost =
           make_objective_function<floatingpointT>(pb.objective, variables);
-        auto norm_costs = normalize_costs(ctx, p.norm, cost, rng);
+        renumber.apply(cost);
         auto cost_constant = pb.objective.value;
         auto names = std::move(pb.vars.names);
+        renumber.apply(names);
+        auto upper = make_upper_bounds(pb.vars);
+        renumber.apply(upper);
 
         bx::clear(pb);
 
-        solver_functor<floatingpointT, modeT, constraintOrderT, randomT> slv(
-          ctx, rng, names, affected_vars);
+        const solver_structure<preferenceT> structure(
+          variables,
+          constraints,
+          upper.empty() ? load_init_solution(ctx, p, names) : x_type(),
+          std::move(upper));
+        std::vector<bx::itm::merged_constraint>().swap(constraints);
+
+        // The components of a decomposed problem share the progress mutex
+        // of their merger.
+
+        std::mutex local_mutex;
+        auto& progress_mutex =
+          component ? component->merger->mutex() : local_mutex;
 
-        ret = slv(constraints, variables, cost, norm_costs, cost_constant, p);
+        if (thread > 1) {
+            ret = race<floatingpointT,
+                       preferenceT,
+                       modeT,
+                       constraintOrderT,
+                       randomT,
+                       solverT>(ctx,
+                                structure,
+                                cost,
+                                cost_constant,
+                                p,
+                                seed,
+                                thread,
+                                names,
+                                affected_vars,
+                                renumber,
+                                progress_mutex,
+                                component);
+        } else {
+            auto norm_costs = normalize_costs(ctx, p.norm, cost, rng);
+
+            solver_functor<floatingpointT,
+                           preferenceT,
+                           modeT,
+                           constraintOrderT,
+                           randomT,
+                           solverT>
+              slv(ctx,
+                  rng,
+                  progress_mutex,
+                  names,
+                  affected_vars,
+                  renumber,
+                  component);
+
+            ret = slv(structure, cost, norm_costs, cost_constant, p);
+            ret.method = "inequalities_Zcoeff solver";
+            ret.seed = seed;
+        }
+
+        renumber.restore(ret.variable_value);
+        renumber.restore(names);
 
-        ret.method = "inequalities_Zcoeff solver";
         ret.variable_name = std::move(names);
     } else {
         ret.status = bx::result_status::success;
+        ret.value = pb.objective.value;
     }
     ret.affected_vars = std::move(affected_vars);
 
@@ -2062,9 +3638,12 @@ solve(std::shared_ptr<bx::context> ctx,
 }
 
 template<typename floatingpointT,
+         typename preferenceT,
          typename modeT,
          typename constraintOrderT,
-         typename randomT>
+         typename randomT,
+         typename solverT =
+           solver<floatingpointT, preferenceT, modeT, randomT>>
 static bx::result
 optimize(std::shared_ptr<bx::context> ctx,
          bx::problem& pb,
@@ -2086,14 +3665,80 @@ optimize(std::shared_ptr<bx::context> ctx,
           std::chrono::system_clock::now().time_since_epoch().count()));
 
         auto variables = bx::numeric_cast<int>(pb.vars.values.size());
+        const bx::itm::renumbering renumber(ctx, constraints, variables);
         auto cost =
           make_objective_function<floatingpointT>(pb.objective, variables);
+        renumber.apply(cost);
         auto norm_costs = normalize_costs(ctx, p.norm, cost, rng);
         auto cost_constant = pb.objective.value;
         auto names = std::move(pb.vars.names);
+        renumber.apply(names);
+        auto upper = make_upper_bounds(pb.vars);
+        renumber.apply(upper);
 
         bx::clear(pb);
 
+        // The structure of the problem is built once and shared read-only by
+        // all the threads, the merged constraints are no longer needed. With
+        // numa-replicate, one copy is built per NUMA node by a thread pinned
+        // on this node so its pages are allocated on the node.
+
+        const auto init =
+          upper.empty() ? load_init_solution(ctx, p, names) : x_type();
+        const bx::itm::thread_placement placement(ctx, thread);
+        std::vector<std::unique_ptr<solver_structure<preferenceT>>> structures(
+          placement.replicate() ? placement.nodes() : 1);
+
+        if (placement.replicate()) {
+            std::vector<std::thread> builders;
+
+            for (int node = 0, e = placement.nodes(); node != e; ++node)
+                builders.emplace_back(
+                  [&placement, &structures, &constraints, &init, &upper,
+                   variables, node]() {
+                      placement.pin_node(node);
+                      structures[node] =
+                        std::make_unique<solver_structure<preferenceT>>(
+                          variables, constraints, init, upper);
+                  });
+
+            for (auto& t : builders)
+                t.join();
+        } else {
+            structures[0] = std::make_unique<solver_structure<preferenceT>>(
+              variables, constraints, init, upper);
+        }
+
+        std::vector<bx::itm::merged_constraint>().swap(constraints);
+
+        const bx::checkpoint checkpoint(
+          ctx,
+          problem_hash<floatingpointT, preferenceT, modeT>(
+            *structures[0], cost, names));
+
+        // The portfolio computes once the normalized costs of each norm used
+        // by its configurations.
+
+        std::unique_ptr<bx::itm::portfolio> configurations;
+        std::unordered_map<std::string, c_type<floatingpointT>>
+          portfolio_costs;
+
+        if (p.portfolio != bx::itm::portfolio_type::none) {
+            configurations = std::make_unique<bx::itm::portfolio>(
+              ctx,
+              p,
+              std::is_same<modeT, bx::minimize_tag>::value,
+              static_cast<unsigned>(rng()));
+
+            for (int i = 0, e = configurations->size(); i != e; ++i) {
+                const auto& norm = configurations->configuration(i).norm;
+                if (portfolio_costs.find(norm) == portfolio_costs.end())
+                    portfolio_costs.emplace(
+                      norm, normalize_costs(ctx, norm, cost, rng));
+            }
+        }
+
+        std::mutex progress_mutex;
         std::vector<std::thread> pool(thread);
         pool.clear();
         std::vector<std::future<bx::result>> results(thread);
@@ -2112,13 +3757,27 @@ optimize(std::shared_ptr<bx::context> ctx,
             auto seed =
               bx::numeric_cast<typename randomT::result_type>(dst(rng));
 
+            const auto& structure =
+              *structures[placement.replicate() ? placement.node(i) : 0];
+
             std::packaged_task<bx::result()> task(std::bind(
               optimize_functor<floatingpointT,
+                               preferenceT,
                                modeT,
                                constraintOrderT,
-                               randomT>(ctx, i, seed, names, affected_vars),
-              std::ref(constraints),
-              variables,
+                               randomT,
+                               solverT>(
+                ctx,
+                i,
+                seed,
+                progress_mutex,
+                configurations.get(),
+                &portfolio_costs,
+                names,
+                affected_vars,
+                renumber,
+                checkpoint),
+              std::cref(structure),
               std::ref(cost),
               std::ref(norm_costs),
               cost_constant,
@@ -2126,64 +3785,206 @@ optimize(std::shared_ptr<bx::context> ctx,
 
             results.emplace_back(task.get_future());
 
-            pool.emplace_back(std::thread(std::move(task)));
+            // The thread is pinned before the construction of its solver:
+            // P, R, pi and x are first-touched on the node of the thread.
+
+            pool.emplace_back(
+              [&placement, i](std::packaged_task<bx::result()> job) {
+                  placement.pin(i);
+                  job();
+              },
+              std::move(task));
+        }
+
+        for (auto& t : pool)
+            t.join();
+
+        ret = results[0].get();
+        for (int i{ 1 }; i != thread; ++i) {
+            auto current = results[i].get();
+            if (current.status == bx::result_status::success) {
+                if (ret.status != bx::result_status::success or
+                    is_better_solution(current.value, ret.value, modeT()))
+                    ret = current;
+            }
         }
 
-        for (auto& t : pool)
-            t.join();
+        renumber.restore(ret.variable_value);
+        renumber.restore(names);
+
+        ret.method = "inequalities_Zcoeff optimizer";
+        ret.variable_name = std::move(names);
+    } else {
+        ret.status = bx::result_status::success;
+        ret.value = pb.objective.value;
+    }
+    ret.affected_vars = std::move(affected_vars);
+
+    return ret;
+}
+
+template<typename realT,
+         typename preferenceT,
+         typename modeT,
+         typename randomT>
+static bx::result
+dispatch_solve_order(std::shared_ptr<bx::context> ctx,
+                     bx::problem& pb,
+                     const bx::itm::parameters& p,
+                     int thread,
+                     const bx::itm::progress_component* component)
+{
+    switch (p.order) {
+    case bx::itm::constraint_order::none:
+        return ::solve<realT,
+                       preferenceT,
+                       modeT,
+                       ::compute_none<realT, randomT>,
+                       randomT>(ctx, pb, p, thread, component);
+    case bx::itm::constraint_order::reversing:
+        return ::solve<realT,
+                       preferenceT,
+                       modeT,
+                       ::compute_reversing<realT, randomT>,
+                       randomT>(ctx, pb, p, thread, component);
+    case bx::itm::constraint_order::random_sorting:
+        return ::solve<realT,
+                       preferenceT,
+                       modeT,
+                       ::compute_random<realT, randomT>,
+                       randomT>(ctx, pb, p, thread, component);
+    case bx::itm::constraint_order::infeasibility_decr:
+        return ::solve<realT,
+                       preferenceT,
+                       modeT,
+                       ::compute_infeasibility<realT,
+                                               randomT,
+                                               ::compute_infeasibility_decr>,
+                       randomT>(ctx, pb, p, thread, component);
+    case bx::itm::constraint_order::infeasibility_incr:
+        return ::solve<realT,
+                       preferenceT,
+                       modeT,
+                       ::compute_infeasibility<realT,
+                                               randomT,
+                                               ::compute_infeasibility_incr>,
+                       randomT>(ctx, pb, p, thread, component);
+    }
+
+    return {};
+}
 
-        ret = results[0].get();
-        for (int i{ 1 }; i != thread; ++i) {
-            auto current = results[i].get();
-            if (current.status == bx::result_status::success) {
-                if (ret.status != bx::result_status::success or
-                    is_better_solution(current.value, ret.value, modeT()))
-                    ret = current;
-            }
-        }
+template<typename realT,
+         typename preferenceT,
+         typename modeT,
+         typename randomT>
+static bx::result
+dispatch_optimize_order(std::shared_ptr<bx::context> ctx,
+                        bx::problem& pb,
+                        const bx::itm::parameters& p,
+                        int thread)
+{
+    if (p.portfolio != bx::itm::portfolio_type::none)
+        return ::optimize<realT,
+                          preferenceT,
+                          modeT,
+                          ::compute_portfolio<realT, randomT>,
+                          randomT>(ctx, pb, p, thread);
 
-        ret.method = "inequalities_Zcoeff optimizer";
-        ret.variable_name = std::move(names);
-    } else {
-        ret.status = bx::result_status::success;
+    switch (p.order) {
+    case bx::itm::constraint_order::none:
+        return ::optimize<realT,
+                          preferenceT,
+                          modeT,
+                          ::compute_none<realT, randomT>,
+                          randomT>(ctx, pb, p, thread);
+    case bx::itm::constraint_order::reversing:
+        return ::optimize<realT,
+                          preferenceT,
+                          modeT,
+                          ::compute_reversing<realT, randomT>,
+                          randomT>(ctx, pb, p, thread);
+    case bx::itm::constraint_order::random_sorting:
+        return ::optimize<realT,
+                          preferenceT,
+                          modeT,
+                          ::compute_random<realT, randomT>,
+                          randomT>(ctx, pb, p, thread);
+    case bx::itm::constraint_order::infeasibility_decr:
+        return ::optimize<
+          realT,
+          preferenceT,
+          modeT,
+          ::compute_infeasibility<realT,
+                                  randomT,
+                                  ::compute_infeasibility_decr>,
+          randomT>(ctx, pb, p, thread);
+    case bx::itm::constraint_order::infeasibility_incr:
+        return ::optimize<
+          realT,
+          preferenceT,
+          modeT,
+          ::compute_infeasibility<realT,
+                                  randomT,
+                                  ::compute_infeasibility_incr>,
+          randomT>(ctx, pb, p, thread);
     }
-    ret.affected_vars = std::move(affected_vars);
 
-    return ret;
+    return {};
 }
 
+//
+// The integer solver stores the preference matrix P with the real type.
+//
 template<typename realT, typename modeT, typename randomT>
 static bx::result
-dispatch_solve(std::shared_ptr<bx::context> ctx,
-               bx::problem& pb,
-               const bx::itm::parameters& p)
+dispatch_integer_solve(std::shared_ptr<bx::context> ctx,
+                       bx::problem& pb,
+                       const bx::itm::parameters& p,
+                       int thread)
 {
+    using solver_type = integer_solver<realT, realT, modeT, randomT>;
+
     switch (p.order) {
     case bx::itm::constraint_order::none:
-        return ::solve<realT, modeT, ::compute_none<realT, randomT>, randomT>(
-          ctx, pb, p);
+        return ::solve<realT,
+                       realT,
+                       modeT,
+                       ::compute_none<realT, randomT>,
+                       randomT,
+                       solver_type>(ctx, pb, p, thread, nullptr);
     case bx::itm::constraint_order::reversing:
-        return ::
-          solve<realT, modeT, ::compute_reversing<realT, randomT>, randomT>(
-            ctx, pb, p);
+        return ::solve<realT,
+                       realT,
+                       modeT,
+                       ::compute_reversing<realT, randomT>,
+                       randomT,
+                       solver_type>(ctx, pb, p, thread, nullptr);
     case bx::itm::constraint_order::random_sorting:
-        return ::
-          solve<realT, modeT, ::compute_random<realT, randomT>, randomT>(
-            ctx, pb, p);
+        return ::solve<realT,
+                       realT,
+                       modeT,
+                       ::compute_random<realT, randomT>,
+                       randomT,
+                       solver_type>(ctx, pb, p, thread, nullptr);
     case bx::itm::constraint_order::infeasibility_decr:
         return ::solve<realT,
+                       realT,
                        modeT,
                        ::compute_infeasibility<realT,
                                                randomT,
                                                ::compute_infeasibility_decr>,
-                       randomT>(ctx, pb, p);
+                       randomT,
+                       solver_type>(ctx, pb, p, thread, nullptr);
     case bx::itm::constraint_order::infeasibility_incr:
         return ::solve<realT,
+                       realT,
                        modeT,
                        ::compute_infeasibility<realT,
                                                randomT,
                                                ::compute_infeasibility_incr>,
-                       randomT>(ctx, pb, p);
+                       randomT,
+                       solver_type>(ctx, pb, p, thread, nullptr);
     }
 
     return {};
@@ -2191,45 +3992,321 @@ dispatch_solve(std::shared_ptr<bx::context> ctx,
 
 template<typename realT, typename modeT, typename randomT>
 static bx::result
-dispatch_optimize(std::shared_ptr<bx::context> ctx,
-                  bx::problem& pb,
-                  const bx::itm::parameters& p,
-                  int thread)
+dispatch_integer_optimize(std::shared_ptr<bx::context> ctx,
+                          bx::problem& pb,
+                          const bx::itm::parameters& p,
+                          int thread)
 {
+    using solver_type = integer_solver<realT, realT, modeT, randomT>;
+
     switch (p.order) {
     case bx::itm::constraint_order::none:
-        return ::
-          optimize<realT, modeT, ::compute_none<realT, randomT>, randomT>(
-            ctx, pb, p, thread);
+        return ::optimize<realT,
+                          realT,
+                          modeT,
+                          ::compute_none<realT, randomT>,
+                          randomT,
+                          solver_type>(ctx, pb, p, thread);
     case bx::itm::constraint_order::reversing:
-        return ::
-          optimize<realT, modeT, ::compute_reversing<realT, randomT>, randomT>(
-            ctx, pb, p, thread);
+        return ::optimize<realT,
+                          realT,
+                          modeT,
+                          ::compute_reversing<realT, randomT>,
+                          randomT,
+                          solver_type>(ctx, pb, p, thread);
     case bx::itm::constraint_order::random_sorting:
-        return ::
-          optimize<realT, modeT, ::compute_random<realT, randomT>, randomT>(
-            ctx, pb, p, thread);
+        return ::optimize<realT,
+                          realT,
+                          modeT,
+                          ::compute_random<realT, randomT>,
+                          randomT,
+                          solver_type>(ctx, pb, p, thread);
     case bx::itm::constraint_order::infeasibility_decr:
         return ::optimize<
+          realT,
           realT,
           modeT,
           ::compute_infeasibility<realT,
                                   randomT,
                                   ::compute_infeasibility_decr>,
-          randomT>(ctx, pb, p, thread);
+          randomT,
+          solver_type>(ctx, pb, p, thread);
     case bx::itm::constraint_order::infeasibility_incr:
         return ::optimize<
+          realT,
           realT,
           modeT,
           ::compute_infeasibility<realT,
                                   randomT,
                                   ::compute_infeasibility_incr>,
-          randomT>(ctx, pb, p, thread);
+          randomT,
+          solver_type>(ctx, pb, p, thread);
+    }
+
+    return {};
+}
+
+//
+// The preference matrix P can be stored with a smaller type than the real
+// used for reduced costs, Lagrangian multipliers and accumulations to reduce
+// the memory bandwidth on huge models.
+//
+template<typename realT, typename modeT, typename randomT>
+static bx::result
+dispatch_solve(std::shared_ptr<bx::context> ctx,
+               bx::problem& pb,
+               const bx::itm::parameters& p,
+               int thread,
+               const bx::itm::progress_component* component)
+{
+    switch (p.preference_matrix) {
+    case bx::itm::preference_matrix_type::default_type:
+        return dispatch_solve_order<realT, realT, modeT, randomT>(
+          ctx, pb, p, thread, component);
+    case bx::itm::preference_matrix_type::float_type:
+        return dispatch_solve_order<realT, float, modeT, randomT>(
+          ctx, pb, p, thread, component);
+    case bx::itm::preference_matrix_type::bfloat16_type:
+        return dispatch_solve_order<realT, bx::bfloat16, modeT, randomT>(
+          ctx, pb, p, thread, component);
+    }
+
+    return {};
+}
+
+template<typename realT, typename modeT, typename randomT>
+static bx::result
+dispatch_optimize(std::shared_ptr<bx::context> ctx,
+                  bx::problem& pb,
+                  const bx::itm::parameters& p,
+                  int thread)
+{
+    switch (p.preference_matrix) {
+    case bx::itm::preference_matrix_type::default_type:
+        return dispatch_optimize_order<realT, realT, modeT, randomT>(
+          ctx, pb, p, thread);
+    case bx::itm::preference_matrix_type::float_type:
+        return dispatch_optimize_order<realT, float, modeT, randomT>(
+          ctx, pb, p, thread);
+    case bx::itm::preference_matrix_type::bfloat16_type:
+        return dispatch_optimize_order<realT, bx::bfloat16, modeT, randomT>(
+          ctx, pb, p, thread);
     }
 
     return {};
 }
 
+//
+// Memory estimation. The estimate splits the memory used by the structures
+// shared between threads (merged constraints, cost vectors and the solver
+// structure: A, C, Z and b) and the memory of one solver thread (P, R, pi,
+// x, best solution and local search). It is computed before the merge of the
+// constraints so it is an upper bound.
+//
+
+struct problem_size
+{
+    std::size_t m = 0;        // constraints
+    std::size_t n = 0;        // variables
+    std::size_t elements = 0; // non zero elements
+    std::size_t negative = 0; // negative coefficients
+    std::size_t row_max = 0;  // length of the largest constraint
+};
+
+template<typename constraintsT>
+static void
+add_problem_size(problem_size& size, const constraintsT& csts) noexcept
+{
+    size.m += csts.size();
+
+    for (const auto& cst : csts) {
+        size.elements += cst.elements.size();
+        size.row_max = std::max(size.row_max, cst.elements.size());
+
+        for (const auto& elem : cst.elements)
+            if (elem.factor < 0)
+                ++size.negative;
+    }
+}
+
+static problem_size
+make_problem_size(const bx::problem& pb) noexcept
+{
+    problem_size ret;
+    ret.n = pb.vars.values.size();
+
+    add_problem_size(ret, pb.equal_constraints);
+    add_problem_size(ret, pb.greater_constraints);
+    add_problem_size(ret, pb.less_constraints);
+
+    return ret;
+}
+
+struct memory_estimate
+{
+    std::size_t shared = 0;
+    std::size_t thread = 0;
+
+    std::size_t total(int threads) const noexcept
+    {
+        return shared + thread * static_cast<std::size_t>(threads);
+    }
+};
+
+template<typename floatingpointT, typename preferenceT>
+static memory_estimate
+estimate_memory(const problem_size& s, const bx::itm::parameters& p) noexcept
+{
+    using access = typename AP_type<preferenceT>::access;
+
+    memory_estimate ret;
+
+    ret.shared = s.elements * sizeof(bx::function_element) +
+                 s.m * sizeof(bx::itm::merged_constraint) +
+                 2 * s.n * sizeof(floatingpointT);
+
+    if (p.portfolio != bx::itm::portfolio_type::none)
+        ret.shared += 4 * s.n * sizeof(floatingpointT);
+
+    ret.shared +=
+      2 * s.elements * sizeof(access) + s.elements * sizeof(int) +
+      (s.m + s.n + 2) * sizeof(int) + (s.m + 1) * sizeof(int) +
+      s.negative * sizeof(c_data) + s.m / 8 + s.m * sizeof(bound) +
+      (s.m + 1) * sizeof(int) +
+      s.elements * sizeof(row_bitmaps::word_mask);
+
+    ret.thread = s.elements * sizeof(preferenceT) +
+                 s.row_max * sizeof(r_data<floatingpointT>) +
+                 s.m * sizeof(floatingpointT) +
+                 2 * bx::bit_array::words(s.n) * sizeof(std::uint64_t) +
+                 (s.m + s.n) * sizeof(int) + 2 * s.m * sizeof(int) +
+                 s.n * sizeof(int);
+
+    return ret;
+}
+
+template<typename floatingpointT>
+static memory_estimate
+estimate_memory(const problem_size& s, const bx::itm::parameters& p) noexcept
+{
+    switch (p.preference_matrix) {
+    case bx::itm::preference_matrix_type::float_type:
+        return estimate_memory<floatingpointT, float>(s, p);
+    case bx::itm::preference_matrix_type::bfloat16_type:
+        return estimate_memory<floatingpointT, bx::bfloat16>(s, p);
+    default:
+        return estimate_memory<floatingpointT, floatingpointT>(s, p);
+    }
+}
+
+static memory_estimate
+estimate_memory(const problem_size& s, const bx::itm::parameters& p) noexcept
+{
+    switch (p.float_type) {
+    case bx::itm::floating_point_type::float_type:
+        return estimate_memory<float>(s, p);
+    case bx::itm::floating_point_type::longdouble_type:
+        return estimate_memory<long double>(s, p);
+    default:
+        return estimate_memory<double>(s, p);
+    }
+}
+
+//
+// Use a smaller storage for the preference matrix, then for the reals. This
+// function returns false if no smaller type is available.
+//
+static bool
+reduce_precision(bx::itm::parameters& p) noexcept
+{
+    using bx::itm::floating_point_type;
+    using bx::itm::preference_matrix_type;
+
+    switch (p.preference_matrix) {
+    case preference_matrix_type::default_type:
+        if (p.float_type != floating_point_type::float_type) {
+            p.preference_matrix = preference_matrix_type::float_type;
+            return true;
+        }
+        p.preference_matrix = preference_matrix_type::bfloat16_type;
+        return true;
+    case preference_matrix_type::float_type:
+        p.preference_matrix = preference_matrix_type::bfloat16_type;
+        return true;
+    case preference_matrix_type::bfloat16_type:
+        break;
+    }
+
+    switch (p.float_type) {
+    case floating_point_type::longdouble_type:
+        p.float_type = floating_point_type::double_type;
+        return true;
+    case floating_point_type::double_type:
+        p.float_type = floating_point_type::float_type;
+        return true;
+    case floating_point_type::float_type:
+        break;
+    }
+
+    return false;
+}
+
+//
+// Fits the configuration in the @c memory-limit parameter (in MiB, no limit
+// if less or equal to 0): the number of threads is reduced first, the
+// precision of P and of the reals only if one thread does not fit. Returns
+// the memory estimate in bytes or throws a @c solver_failure.
+//
+static std::size_t
+fit_memory_limit(const std::shared_ptr<bx::context>& ctx,
+                 const bx::problem& pb,
+                 bx::itm::parameters& p,
+                 int& thread)
+{
+    const auto size = make_problem_size(pb);
+    const auto limit = ctx->get_real_parameter("memory-limit", 0.0);
+    auto estimate = estimate_memory(size, p);
+
+    if (limit > 0.0) {
+        const auto budget = static_cast<std::size_t>(limit * 1024.0 * 1024.0);
+
+        while (estimate.total(1) > budget) {
+            if (not reduce_precision(p)) {
+                error(ctx,
+                      "  - memory-limit: {:.3f} MiB required at least, {} MiB "
+                      "available\n",
+                      estimate.total(1) / (1024.0 * 1024.0),
+                      limit);
+
+                throw bx::solver_failure(
+                  bx::solver_error_tag::not_enough_memory);
+            }
+
+            estimate = estimate_memory(size, p);
+        }
+
+        const auto fit = (budget - estimate.shared) / estimate.thread;
+        if (static_cast<std::size_t>(thread) > fit)
+            thread = static_cast<int>(fit);
+
+        info(ctx,
+             "  - memory-limit: {} thread(s), floating-point-type: {}, "
+             "preference-matrix-type: {}\n",
+             thread,
+             bx::itm::floating_point_type_to_string(p.float_type),
+             bx::itm::preference_matrix_type_to_string(p.preference_matrix));
+    }
+
+    info(ctx,
+         "  - memory estimate: {:.3f} MiB ({:.3f} MiB shared, {:.3f} MiB per "
+         "thread)\n",
+         estimate.total(thread) / (1024.0 * 1024.0),
+         estimate.shared / (1024.0 * 1024.0),
+         estimate.thread / (1024.0 * 1024.0));
+
+    return estimate.total(thread);
+}
+
 } // anonymous namespace
 
 namespace baryonyx {
@@ -2238,41 +4315,153 @@ namespace itm {
 result
 inequalities_Zcoeff_wedelin_solve(
   const std::shared_ptr<baryonyx::context>& ctx,
-  problem& pb)
+  problem& pb,
+  int thread,
+  const progress_component* component)
 {
     info(ctx, "inequalities_Zcoeff_wedelin_solve\n");
     parameters p(ctx);
 
+    const auto memory = fit_memory_limit(ctx, pb, p, thread);
+
     using random_type = std::default_random_engine;
     // using random_type = std::mt19937;
+    result ret;
 
     if (pb.type == baryonyx::objective_function_type::maximize) {
         switch (p.float_type) {
         case floating_point_type::float_type:
-            return dispatch_solve<float, maximize_tag, random_type>(
-              ctx, pb, p);
+            ret = dispatch_solve<float, maximize_tag, random_type>(
+              ctx, pb, p, thread, component);
+            break;
         case floating_point_type::double_type:
-            return dispatch_solve<double, maximize_tag, random_type>(
-              ctx, pb, p);
+            ret = dispatch_solve<double, maximize_tag, random_type>(
+              ctx, pb, p, thread, component);
+            break;
         case floating_point_type::longdouble_type:
-            return dispatch_solve<long double, maximize_tag, random_type>(
-              ctx, pb, p);
+            ret = dispatch_solve<long double, maximize_tag, random_type>(
+              ctx, pb, p, thread, component);
+            break;
         }
     } else {
         switch (p.float_type) {
         case floating_point_type::float_type:
-            return dispatch_solve<float, minimize_tag, random_type>(
-              ctx, pb, p);
+            ret = dispatch_solve<float, minimize_tag, random_type>(
+              ctx, pb, p, thread, component);
+            break;
         case floating_point_type::double_type:
-            return dispatch_solve<double, minimize_tag, random_type>(
-              ctx, pb, p);
+            ret = dispatch_solve<double, minimize_tag, random_type>(
+              ctx, pb, p, thread, component);
+            break;
         case floating_point_type::longdouble_type:
-            return dispatch_solve<long double, minimize_tag, random_type>(
-              ctx, pb, p);
+            ret = dispatch_solve<long double, minimize_tag, random_type>(
+              ctx, pb, p, thread, component);
+            break;
         }
     }
 
-    return {};
+    ret.memory_estimate = memory;
+
+    return ret;
+}
+
+result
+inequalities_Zcoeff_integer_solve(const std::shared_ptr<baryonyx::context>& ctx,
+                                  problem& pb,
+                                  int thread)
+{
+    info(ctx, "inequalities_Zcoeff_integer_solve\n");
+    parameters p(ctx);
+
+    using random_type = std::default_random_engine;
+    result ret;
+
+    if (pb.type == baryonyx::objective_function_type::maximize) {
+        switch (p.float_type) {
+        case floating_point_type::float_type:
+            ret = dispatch_integer_solve<float, maximize_tag, random_type>(
+              ctx, pb, p, thread);
+            break;
+        case floating_point_type::double_type:
+            ret = dispatch_integer_solve<double, maximize_tag, random_type>(
+              ctx, pb, p, thread);
+            break;
+        case floating_point_type::longdouble_type:
+            ret =
+              dispatch_integer_solve<long double, maximize_tag, random_type>(
+                ctx, pb, p, thread);
+            break;
+        }
+    } else {
+        switch (p.float_type) {
+        case floating_point_type::float_type:
+            ret = dispatch_integer_solve<float, minimize_tag, random_type>(
+              ctx, pb, p, thread);
+            break;
+        case floating_point_type::double_type:
+            ret = dispatch_integer_solve<double, minimize_tag, random_type>(
+              ctx, pb, p, thread);
+            break;
+        case floating_point_type::longdouble_type:
+            ret =
+              dispatch_integer_solve<long double, minimize_tag, random_type>(
+                ctx, pb, p, thread);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+result
+inequalities_Zcoeff_integer_optimize(
+  const std::shared_ptr<baryonyx::context>& ctx,
+  problem& pb,
+  int thread)
+{
+    info(ctx, "inequalities_Zcoeff_integer_optimize\n");
+    parameters p(ctx);
+
+    using random_type = std::default_random_engine;
+    result ret;
+
+    if (pb.type == baryonyx::objective_function_type::maximize) {
+        switch (p.float_type) {
+        case floating_point_type::float_type:
+            ret = dispatch_integer_optimize<float, maximize_tag, random_type>(
+              ctx, pb, p, thread);
+            break;
+        case floating_point_type::double_type:
+            ret =
+              dispatch_integer_optimize<double, maximize_tag, random_type>(
+                ctx, pb, p, thread);
+            break;
+        case floating_point_type::longdouble_type:
+            ret = dispatch_integer_optimize<long double,
+                                            maximize_tag,
+                                            random_type>(ctx, pb, p, thread);
+            break;
+        }
+    } else {
+        switch (p.float_type) {
+        case floating_point_type::float_type:
+            ret = dispatch_integer_optimize<float, minimize_tag, random_type>(
+              ctx, pb, p, thread);
+            break;
+        case floating_point_type::double_type:
+            ret =
+              dispatch_integer_optimize<double, minimize_tag, random_type>(
+                ctx, pb, p, thread);
+            break;
+        case floating_point_type::longdouble_type:
+            ret = dispatch_integer_optimize<long double,
+                                            minimize_tag,
+                                            random_type>(ctx, pb, p, thread);
+            break;
+        }
+    }
+
+    return ret;
 }
 
 result
@@ -2284,36 +4473,47 @@ inequalities_Zcoeff_wedelin_optimize(
     info(ctx, "inequalities_Zcoeff_wedelin_optimize\n");
     parameters p(ctx);
 
+    const auto memory = fit_memory_limit(ctx, pb, p, thread);
+
     using random_type = std::default_random_engine;
     // using random_type = std::mt19937;
+    result ret;
 
     if (pb.type == baryonyx::objective_function_type::maximize) {
         switch (p.float_type) {
         case floating_point_type::float_type:
-            return dispatch_optimize<float, maximize_tag, random_type>(
+            ret = dispatch_optimize<float, maximize_tag, random_type>(
               ctx, pb, p, thread);
+            break;
         case floating_point_type::double_type:
-            return dispatch_optimize<double, maximize_tag, random_type>(
+            ret = dispatch_optimize<double, maximize_tag, random_type>(
               ctx, pb, p, thread);
+            break;
         case floating_point_type::longdouble_type:
-            return dispatch_optimize<long double, maximize_tag, random_type>(
+            ret = dispatch_optimize<long double, maximize_tag, random_type>(
               ctx, pb, p, thread);
+            break;
         }
     } else {
         switch (p.float_type) {
         case floating_point_type::float_type:
-            return dispatch_optimize<float, minimize_tag, random_type>(
+            ret = dispatch_optimize<float, minimize_tag, random_type>(
               ctx, pb, p, thread);
+            break;
         case floating_point_type::double_type:
-            return dispatch_optimize<double, minimize_tag, random_type>(
+            ret = dispatch_optimize<double, minimize_tag, random_type>(
               ctx, pb, p, thread);
+            break;
         case floating_point_type::longdouble_type:
-            return dispatch_optimize<long double, minimize_tag, random_type>(
+            ret = dispatch_optimize<long double, minimize_tag, random_type>(
               ctx, pb, p, thread);
+            break;
         }
     }
 
-    return {};
+    ret.memory_estimate = memory;
+
+    return ret;
 }
 }
 }
@@ -0,0 +1,99 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <baryonyx/core>
+
+#include "private.hpp"
+#include "utils.hpp"
+
+#include <limits>
+
+namespace bx = baryonyx;
+
+template<typename constraintsT>
+static void
+shift_constraints(constraintsT& csts, const std::vector<int>& lower)
+{
+    for (auto& cst : csts)
+        for (const auto& elem : cst.elements)
+            cst.value -= elem.factor * lower[elem.variable_index];
+}
+
+namespace baryonyx_private {
+
+std::vector<int>
+shift_integer_variables(const std::shared_ptr<bx::context>& ctx,
+                        bx::problem& pb)
+{
+    const int limit = ctx->get_integer_parameter("integer-domain-limit", 16);
+
+    std::vector<int> lower(pb.vars.values.size(), 0);
+    int general = 0;
+
+    for (std::size_t i = 0, e = pb.vars.values.size(); i != e; ++i) {
+        auto& value = pb.vars.values[i];
+
+        if (value.type == bx::variable_type::binary)
+            continue;
+
+        if (value.type != bx::variable_type::general or
+            value.max == std::numeric_limits<int>::max() or
+            value.max - value.min > limit) {
+            error(ctx,
+                  "variable {} has not a small bounded integer domain "
+                  "(integer-domain-limit: {})\n",
+                  pb.vars.names[i],
+                  limit);
+
+            throw bx::solver_failure(
+              bx::solver_error_tag::no_solver_available);
+        }
+
+        ++general;
+        lower[i] = value.min;
+        value.max -= value.min;
+        value.min = 0;
+    }
+
+    info(ctx, "  - integer variables: {}\n", general);
+
+    shift_constraints(pb.equal_constraints, lower);
+    shift_constraints(pb.less_constraints, lower);
+    shift_constraints(pb.greater_constraints, lower);
+
+    for (const auto& elem : pb.objective.elements)
+        pb.objective.value += elem.factor * lower[elem.variable_index];
+
+    return lower;
+}
+
+bx::result
+restore_integer_variables(const std::vector<int>& lower, bx::result r)
+{
+    if (r.variable_value.size() == lower.size())
+        for (std::size_t i = 0, e = lower.size(); i != e; ++i)
+            r.variable_value[i] += lower[i];
+
+    return r;
+}
+
+} // namespace baryonyx_private
@@ -22,9 +22,18 @@
 
 #include "itm.hpp"
 
+#include <fstream>
+#include <numeric>
 #include <set>
+#include <sstream>
 
 #include <cassert>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace bx = baryonyx;
 
@@ -357,9 +366,515 @@ make_special_merged_constraints(const std::shared_ptr<bx::context>& ctx,
     return ret;
 }
 
+//
+// Built-in portfolio configurations. Each line is a list of `name=value`
+// applied over the global parameters. Settings come from the parameters used
+// in the test suite for different families of problems (queens, assignment,
+// aim, qap etc.).
+//
+static const char* builtin_portfolio[] = {
+    "",
+    "theta=0.5 delta=0.02 kappa-step=0.01 kappa-max=60 w=40 "
+    "constraint-order=infeasibility-decr",
+    "delta=1 kappa-min=0.3 kappa-step=0.01 kappa-max=100 w=60 "
+    "constraint-order=random-sorting",
+    "theta=0.6 kappa-step=0.002 kappa-max=100 w=20",
+    "delta=0.2 kappa-max=10 alpha=0 w=20",
+    "delta=1 kappa-min=0.1 kappa-step=0.0001 kappa-max=1 alpha=2 w=60 "
+    "constraint-order=random-sorting",
+    "theta=0.3 delta=0.001 kappa-step=0.0001 kappa-max=1 w=100 "
+    "constraint-order=reversing init-policy=random",
+    "theta=0.7 delta=0.05 kappa-min=0.1 kappa-step=0.005 kappa-max=10 w=20 "
+    "constraint-order=infeasibility-incr init-policy=best norm=l2",
+    "kappa-policy=adaptive w=20"
+};
+
+//
+// Assigns the `name=value` (or `name:value`) token into the context. Like the
+// command line parser, the type of the value is an integer, a real or a
+// string if the conversion fails.
+//
+static bool
+set_portfolio_parameter(bx::context& ctx, const std::string& token)
+{
+    auto pos = token.find_first_of("=:");
+    if (pos == std::string::npos or pos == 0)
+        return false;
+
+    auto name = token.substr(0, pos);
+    auto value = token.substr(pos + 1);
+    if (value.empty())
+        return false;
+
+    char* end = nullptr;
+    long l = std::strtol(value.c_str(), &end, 10);
+    if (*end == '\0') {
+        ctx.set_parameter(name, static_cast<int>(l));
+        return true;
+    }
+
+    double d = std::strtod(value.c_str(), &end);
+    if (*end == '\0') {
+        ctx.set_parameter(name, d);
+        return true;
+    }
+
+    ctx.set_parameter(name, value);
+    return true;
+}
+
+//
+// Builds the parameters of a configuration: the global parameters of the
+// context are copied into a silent context and the `name=value` tokens of the
+// line override them.
+//
+static bool
+make_portfolio_parameters(const std::shared_ptr<bx::context>& ctx,
+                          const std::string& line,
+                          std::vector<bx::itm::parameters>& configurations)
+{
+    auto tmp = std::make_shared<bx::context>(
+      [](bx::context::message_type, std::string) {});
+
+    for (const auto& elem : ctx->get_parameters()) {
+        switch (elem.second.type) {
+        case bx::parameter::tag::integer:
+            tmp->set_parameter(elem.first, elem.second.l);
+            break;
+        case bx::parameter::tag::real:
+            tmp->set_parameter(elem.first, elem.second.d);
+            break;
+        case bx::parameter::tag::string:
+            tmp->set_parameter(elem.first, elem.second.s);
+            break;
+        }
+    }
+
+    std::istringstream iss(line);
+    std::string token;
+    while (iss >> token) {
+        if (token[0] == '#')
+            break;
+
+        if (not set_portfolio_parameter(*tmp, token)) {
+            warning(ctx, "  - portfolio: bad parameter `{}`\n", token);
+            return false;
+        }
+    }
+
+    configurations.emplace_back(tmp);
+
+    return true;
+}
+
+//
+// Reads the NUMA nodes and their CPUs from the sysfs and keeps the CPUs
+// available to the process. Returns one node with the available CPUs if the
+// sysfs is unavailable.
+//
+
+#ifdef __linux__
+static std::vector<int>
+parse_cpu_list(const std::string& str)
+{
+    std::vector<int> ret;
+    std::istringstream iss(str);
+    std::string range;
+
+    while (std::getline(iss, range, ',')) {
+        auto dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos
+                     ? first
+                     : std::atoi(range.c_str() + dash + 1);
+
+        for (int cpu = first; cpu <= last; ++cpu)
+            ret.emplace_back(cpu);
+    }
+
+    return ret;
+}
+
+static std::vector<std::vector<int>>
+read_numa_nodes()
+{
+    cpu_set_t available;
+    CPU_ZERO(&available);
+
+    if (::sched_getaffinity(0, sizeof(available), &available) != 0)
+        return {};
+
+    std::vector<std::vector<int>> ret;
+
+    for (int node = 0;; ++node) {
+        std::ifstream ifs("/sys/devices/system/node/node" +
+                          std::to_string(node) + "/cpulist");
+        if (not ifs.is_open())
+            break;
+
+        std::string line;
+        std::getline(ifs, line);
+
+        std::vector<int> cpus;
+        for (auto cpu : parse_cpu_list(line))
+            if (cpu < CPU_SETSIZE and CPU_ISSET(cpu, &available))
+                cpus.emplace_back(cpu);
+
+        if (not cpus.empty())
+            ret.emplace_back(std::move(cpus));
+    }
+
+    if (ret.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &available))
+                cpus.emplace_back(cpu);
+
+        if (not cpus.empty())
+            ret.emplace_back(std::move(cpus));
+    }
+
+    return ret;
+}
+
+static void
+set_thread_affinity(const int* cpus, std::size_t size) noexcept
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (std::size_t i = 0; i != size; ++i)
+        CPU_SET(cpus[i], &set);
+
+    ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+}
+#endif
+
+//
+// The bipartite graph of the constraint matrix: vertices [0, m[ are the
+// constraints and vertices [m, m + n[ the variables. The constraints store
+// their variables, the variables are stored in CSR.
+//
+struct constraints_graph
+{
+    constraints_graph(const std::vector<bx::itm::merged_constraint>& csts_,
+                      int n_)
+      : csts(csts_)
+      , access(n_ + 1, 0)
+      , m(bx::length(csts_))
+      , n(n_)
+    {
+        for (const auto& cst : csts)
+            for (const auto& elem : cst.elements)
+                ++access[elem.variable_index + 1];
+
+        for (int j = 0; j != n; ++j)
+            access[j + 1] += access[j];
+
+        rows.resize(access[n]);
+        std::vector<int> cursor(access.begin(), access.end() - 1);
+
+        for (int i = 0; i != m; ++i)
+            for (const auto& elem : csts[i].elements)
+                rows[cursor[elem.variable_index]++] = i;
+    }
+
+    int size() const noexcept
+    {
+        return m + n;
+    }
+
+    int degree(int v) const noexcept
+    {
+        return v < m ? bx::length(csts[v].elements)
+                     : access[v - m + 1] - access[v - m];
+    }
+
+    template<typename Function>
+    void for_each_neighbour(int v, Function f) const
+    {
+        if (v < m) {
+            for (const auto& elem : csts[v].elements)
+                f(m + elem.variable_index);
+        } else {
+            for (int k = access[v - m], e = access[v - m + 1]; k != e; ++k)
+                f(rows[k]);
+        }
+    }
+
+    const std::vector<bx::itm::merged_constraint>& csts;
+    std::vector<int> access;
+    std::vector<int> rows;
+    int m;
+    int n;
+};
+
+//
+// Breadth-first search from @c start in the component of @c start: @c level
+// receives the depth of the vertices, @c visited the vertices in the visit
+// order. Returns the eccentricity of @c start.
+//
+static int
+level_structure(const constraints_graph& g,
+                int start,
+                std::vector<int>& level,
+                std::vector<int>& visited)
+{
+    for (auto v : visited)
+        level[v] = -1;
+
+    visited.clear();
+    visited.emplace_back(start);
+    level[start] = 0;
+
+    for (std::size_t head = 0; head != visited.size(); ++head) {
+        const int v = visited[head];
+        g.for_each_neighbour(v, [&level, &visited, v](int u) {
+            if (level[u] < 0) {
+                level[u] = level[v] + 1;
+                visited.emplace_back(u);
+            }
+        });
+    }
+
+    return level[visited.back()];
+}
+
+//
+// George and Liu heuristic: moves the start vertex to a vertex of minimal
+// degree in the last level while the eccentricity grows.
+//
+static int
+pseudo_peripheral_vertex(const constraints_graph& g,
+                         int start,
+                         std::vector<int>& level,
+                         std::vector<int>& visited)
+{
+    int eccentricity = level_structure(g, start, level, visited);
+
+    for (;;) {
+        int candidate = -1;
+        for (auto it = visited.rbegin(), et = visited.rend();
+             it != et and level[*it] == eccentricity;
+             ++it)
+            if (candidate < 0 or g.degree(*it) < g.degree(candidate))
+                candidate = *it;
+
+        const int next = level_structure(g, candidate, level, visited);
+        if (next <= eccentricity)
+            return start;
+
+        start = candidate;
+        eccentricity = next;
+    }
+}
+
+//
+// Reverse Cuthill-McKee ordering of the vertices of the constraint graph.
+// Each component is numbered from a pseudo-peripheral vertex by a
+// breadth-first search which visits the neighbours by increasing degree.
+//
+static std::vector<int>
+reverse_cuthill_mckee(const constraints_graph& g)
+{
+    std::vector<int> candidates(g.size());
+    std::iota(candidates.begin(), candidates.end(), 0);
+    std::stable_sort(candidates.begin(),
+                     candidates.end(),
+                     [&g](int lhs, int rhs) {
+                         return g.degree(lhs) < g.degree(rhs);
+                     });
+
+    std::vector<int> order, level(g.size(), -1), visited, neighbours;
+    std::vector<char> numbered(g.size(), 0);
+    order.reserve(g.size());
+
+    for (auto candidate : candidates) {
+        if (numbered[candidate])
+            continue;
+
+        const int start =
+          pseudo_peripheral_vertex(g, candidate, level, visited);
+
+        numbered[start] = 1;
+        order.emplace_back(start);
+
+        for (std::size_t head = order.size() - 1; head != order.size();
+             ++head) {
+            neighbours.clear();
+            g.for_each_neighbour(order[head], [&numbered, &neighbours](int u) {
+                if (not numbered[u]) {
+                    numbered[u] = 1;
+                    neighbours.emplace_back(u);
+                }
+            });
+
+            std::stable_sort(neighbours.begin(),
+                             neighbours.end(),
+                             [&g](int lhs, int rhs) {
+                                 return g.degree(lhs) < g.degree(rhs);
+                             });
+
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+
+    return order;
+}
+
+//
+// The sum over the constraints of the distance between the first and the
+// last variable: the locality indicator of the renumbering.
+//
+static long long
+constraints_span(const std::vector<bx::itm::merged_constraint>& csts)
+{
+    long long ret = 0;
+
+    for (const auto& cst : csts) {
+        if (cst.elements.empty())
+            continue;
+
+        auto minmax = std::minmax_element(
+          cst.elements.begin(),
+          cst.elements.end(),
+          [](const auto& lhs, const auto& rhs) {
+              return lhs.variable_index < rhs.variable_index;
+          });
+
+        ret += minmax.second->variable_index - minmax.first->variable_index;
+    }
+
+    return ret;
+}
+
 namespace baryonyx {
 namespace itm {
 
+portfolio::portfolio(const std::shared_ptr<context>& ctx,
+                     const parameters& p,
+                     bool minimize,
+                     unsigned seed)
+  : m_rng(seed)
+  , m_minimize(minimize)
+{
+    if (p.portfolio == portfolio_type::file) {
+        auto filename = ctx->get_string_parameter("portfolio-file", "");
+        std::ifstream ifs(filename);
+
+        if (not ifs.is_open())
+            warning(ctx,
+                    "  - portfolio: fail to open `{}`. Use built-in "
+                    "configurations\n",
+                    filename);
+
+        std::string line;
+        while (std::getline(ifs, line)) {
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos or line[first] == '#')
+                continue;
+
+            make_portfolio_parameters(ctx, line, m_configurations);
+        }
+    }
+
+    if (m_configurations.empty())
+        for (const auto* line : builtin_portfolio)
+            make_portfolio_parameters(ctx, line, m_configurations);
+
+    m_scores.resize(m_configurations.size());
+
+    info(ctx, "  - portfolio: {} configurations\n", m_configurations.size());
+    for (std::size_t i = 0, e = m_configurations.size(); i != e; ++i) {
+        const auto& c = m_configurations[i];
+
+        info(ctx,
+             "    #{}: theta {} delta {} kappa {}/{}/{} alpha {} w {} "
+             "order {} init {} norm {}\n",
+             i,
+             c.theta,
+             c.delta,
+             c.kappa_min,
+             c.kappa_step,
+             c.kappa_max,
+             c.alpha,
+             c.w,
+             constraint_order_to_string(c.order),
+             init_policy_type_to_string(c.init_policy),
+             c.norm);
+    }
+}
+
+bool
+portfolio::is_better(const score& lhs, const score& rhs) const noexcept
+{
+    if (lhs.remaining_constraints != rhs.remaining_constraints)
+        return lhs.remaining_constraints < rhs.remaining_constraints;
+
+    if (lhs.remaining_constraints == 0 and lhs.value != rhs.value)
+        return m_minimize ? lhs.value < rhs.value : lhs.value > rhs.value;
+
+    return lhs.runs < rhs.runs;
+}
+
+int
+portfolio::assign(int thread, int configuration)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto id = configuration >= 0 and configuration < size()
+                ? configuration
+                : thread % size();
+    m_scores[id].running++;
+
+    return id;
+}
+
+int
+portfolio::next(int configuration, int remaining_constraints, double value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    {
+        auto& s = m_scores[configuration];
+        s.runs++;
+        s.running--;
+
+        if (remaining_constraints == 0 and
+            (s.remaining_constraints != 0 or
+             (m_minimize ? value < s.value : value > s.value)))
+            s.value = value;
+
+        if (remaining_constraints < s.remaining_constraints)
+            s.remaining_constraints = remaining_constraints;
+    }
+
+    // Untried configurations first, then, with a low probability, a random
+    // configuration to keep exploring, otherwise the best configuration.
+
+    int id = -1;
+    for (int i = 0, e = size(); i != e and id < 0; ++i)
+        if (m_scores[i].runs == 0 and m_scores[i].running == 0)
+            id = i;
+
+    if (id < 0) {
+        if (std::bernoulli_distribution(0.2)(m_rng)) {
+            id = std::uniform_int_distribution<int>(0, size() - 1)(m_rng);
+        } else {
+            id = 0;
+            for (int i = 1, e = size(); i != e; ++i)
+                if (is_better(m_scores[i], m_scores[id]))
+                    id = i;
+        }
+    }
+
+    m_scores[id].running++;
+
+    return id;
+}
+
 std::vector<merged_constraint>
 make_merged_constraints(const std::shared_ptr<context>& ctx,
                         const problem& pb,
@@ -386,5 +901,136 @@ make_merged_constraints(const std::shared_ptr<context>& ctx,
 
     return ret;
 }
+
+renumbering::renumbering(const std::shared_ptr<context>& ctx,
+                         std::vector<merged_constraint>& csts,
+                         int variables)
+{
+    auto policy = ctx->get_string_parameter("reorder", "none");
+    if (policy != "rcm" and policy != "rcm-variables")
+        return;
+
+    if (csts.empty() or variables <= 0)
+        return;
+
+    const auto before = constraints_span(csts);
+    const int m = length(csts);
+    std::vector<int> rows;
+
+    {
+        const constraints_graph g(csts, variables);
+        const auto order = reverse_cuthill_mckee(g);
+
+        rows.reserve(m);
+        m_variables.reserve(variables);
+        m_index.resize(variables);
+
+        for (auto v : order) {
+            if (v < m) {
+                rows.emplace_back(v);
+            } else {
+                m_index[v - m] = length(m_variables);
+                m_variables.emplace_back(v - m);
+            }
+        }
+    }
+
+    for (auto& cst : csts) {
+        for (auto& elem : cst.elements)
+            elem.variable_index = m_index[elem.variable_index];
+
+        std::sort(cst.elements.begin(),
+                  cst.elements.end(),
+                  [](const auto& lhs, const auto& rhs) {
+                      return lhs.variable_index < rhs.variable_index;
+                  });
+    }
+
+    if (policy == "rcm") {
+        std::vector<merged_constraint> ret;
+        ret.reserve(m);
+
+        for (auto row : rows)
+            ret.emplace_back(std::move(csts[row]));
+
+        csts.swap(ret);
+    }
+
+    info(ctx,
+         "  - reorder: {} (constraints span {} -> {})\n",
+         policy,
+         before,
+         constraints_span(csts));
+}
+
+thread_placement::thread_placement(const std::shared_ptr<context>& ctx,
+                                   int thread)
+{
+    auto policy = ctx->get_string_parameter("thread-affinity", "none");
+    if (policy != "compact" and policy != "scatter")
+        return;
+
+#ifdef __linux__
+    m_node_cpus = read_numa_nodes();
+    if (m_node_cpus.empty())
+        return;
+
+    m_replicate = ctx->get_integer_parameter("numa-replicate", 0) != 0;
+    m_cpus.resize(thread);
+    m_nodes.resize(thread);
+
+    if (policy == "compact") {
+        std::vector<std::pair<int, int>> cpus;
+        for (int node = 0, e = nodes(); node != e; ++node)
+            for (auto cpu : m_node_cpus[node])
+                cpus.emplace_back(cpu, node);
+
+        for (int i = 0; i != thread; ++i) {
+            const auto& elem = cpus[i % cpus.size()];
+            m_cpus[i] = elem.first;
+            m_nodes[i] = elem.second;
+        }
+    } else {
+        for (int i = 0; i != thread; ++i) {
+            const int node = i % nodes();
+            const auto& cpus = m_node_cpus[node];
+
+            m_cpus[i] = cpus[(i / nodes()) % cpus.size()];
+            m_nodes[i] = node;
+        }
+    }
+
+    info(ctx,
+         "  - thread-affinity: {} on {} NUMA node(s){}\n",
+         policy,
+         nodes(),
+         replicate() ? ", structure replicated per node" : "");
+#else
+    warning(ctx, "  - thread-affinity: not available on this system\n");
+#endif
+}
+
+void
+thread_placement::pin(int thread) const noexcept
+{
+#ifdef __linux__
+    if (enabled())
+        set_thread_affinity(&m_cpus[thread], 1);
+#else
+    (void)thread;
+#endif
+}
+
+void
+thread_placement::pin_node(int node) const noexcept
+{
+#ifdef __linux__
+    if (enabled())
+        set_thread_affinity(m_node_cpus[node].data(),
+                            m_node_cpus[node].size());
+#else
+    (void)node;
+#endif
+}
 }
 }
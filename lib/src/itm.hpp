@@ -29,7 +29,12 @@
 #include "utils.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <random>
 #include <utility>
+#include <vector>
 
 namespace baryonyx {
 namespace itm {
@@ -52,26 +57,42 @@ inequalities_101coeff_wedelin_optimize(const std::shared_ptr<context>& ctx,
                                        problem& pb,
                                        int thread);
 
+struct progress_component;
+
 result
-inequalities_Zcoeff_wedelin_solve(const std::shared_ptr<context>& ctx,
-                                  problem& pb);
+inequalities_Zcoeff_wedelin_solve(
+  const std::shared_ptr<context>& ctx,
+  problem& pb,
+  int thread,
+  const progress_component* component = nullptr);
 
 result
 inequalities_Zcoeff_wedelin_optimize(const std::shared_ptr<context>& ctx,
                                      problem& pb,
                                      int thread);
 
+result
+inequalities_Zcoeff_integer_solve(const std::shared_ptr<context>& ctx,
+                                  problem& pb,
+                                  int thread);
+
+result
+inequalities_Zcoeff_integer_optimize(const std::shared_ptr<context>& ctx,
+                                     problem& pb,
+                                     int thread);
+
 enum class init_policy_type
 {
     bastert = 0,
     random,
-    best
+    best,
+    file
 };
 
 inline const char*
 init_policy_type_to_string(init_policy_type type) noexcept
 {
-    static const char* ret[] = { "bastert", "random", "best" };
+    static const char* ret[] = { "bastert", "random", "best", "file" };
 
     return ret[static_cast<int>(type)];
 }
@@ -87,6 +108,9 @@ get_init_policy_type(const std::shared_ptr<context>& ctx) noexcept
     if (str == "best")
         return init_policy_type::best;
 
+    if (str == "file")
+        return init_policy_type::file;
+
     return init_policy_type::bastert;
 }
 
@@ -122,6 +146,119 @@ get_floating_point_type(const std::shared_ptr<context>& ctx) noexcept
     return floating_point_type::double_type;
 }
 
+enum class preference_matrix_type
+{
+    default_type = 0,
+    float_type,
+    bfloat16_type
+};
+
+inline const char*
+preference_matrix_type_to_string(preference_matrix_type type) noexcept
+{
+    static const char* ret[] = {
+        "default",
+        "float",
+        "bfloat16",
+    };
+
+    return ret[static_cast<int>(type)];
+}
+
+inline preference_matrix_type
+get_preference_matrix_type(const std::shared_ptr<context>& ctx) noexcept
+{
+    auto str = ctx->get_string_parameter("preference-matrix-type", "default");
+
+    if (str == "float")
+        return preference_matrix_type::float_type;
+    if (str == "bfloat16")
+        return preference_matrix_type::bfloat16_type;
+
+    return preference_matrix_type::default_type;
+}
+
+enum class kappa_policy_type
+{
+    default_policy = 0,
+    adaptive
+};
+
+inline const char*
+kappa_policy_type_to_string(kappa_policy_type type) noexcept
+{
+    static const char* ret[] = { "default", "adaptive" };
+
+    return ret[static_cast<int>(type)];
+}
+
+inline kappa_policy_type
+get_kappa_policy_type(const std::shared_ptr<context>& ctx) noexcept
+{
+    auto str = ctx->get_string_parameter("kappa-policy", "default");
+
+    if (str == "adaptive")
+        return kappa_policy_type::adaptive;
+
+    return kappa_policy_type::default_policy;
+}
+
+enum class local_search_type
+{
+    none = 0,
+    flip,
+    swap
+};
+
+inline const char*
+local_search_type_to_string(local_search_type type) noexcept
+{
+    static const char* ret[] = { "none", "flip", "swap" };
+
+    return ret[static_cast<int>(type)];
+}
+
+inline local_search_type
+get_local_search_type(const std::shared_ptr<context>& ctx) noexcept
+{
+    auto str = ctx->get_string_parameter("local-search", "none");
+
+    if (str == "flip")
+        return local_search_type::flip;
+    if (str == "swap")
+        return local_search_type::swap;
+
+    return local_search_type::none;
+}
+
+enum class portfolio_type
+{
+    none = 0,
+    builtin,
+    file
+};
+
+inline const char*
+portfolio_type_to_string(portfolio_type type) noexcept
+{
+    static const char* ret[] = { "none", "builtin", "file" };
+
+    return ret[static_cast<int>(type)];
+}
+
+inline portfolio_type
+get_portfolio_type(const std::shared_ptr<context>& ctx) noexcept
+{
+    auto str = ctx->get_string_parameter("portfolio", "none");
+
+    if (str == "builtin")
+        return portfolio_type::builtin;
+    if (str == "file")
+        return portfolio_type::file;
+
+    return portfolio_type::none;
+}
+
 enum class constraint_order
 {
     none = 0,
@@ -168,6 +305,7 @@ struct parameters
       : preprocessing(ctx->get_string_parameter("preprocessing", "none"))
       , norm(ctx->get_string_parameter("norm", "inf"))
       , time_limit(ctx->get_real_parameter("time-limit", -1.0))
+      , progress_period(ctx->get_real_parameter("progress-period", 0.1))
       , theta(ctx->get_real_parameter("theta", 0.5))
       , delta(ctx->get_real_parameter("delta", 0.01))
       , kappa_min(ctx->get_real_parameter("kappa-min", 0.0))
@@ -184,23 +322,38 @@ struct parameters
           ctx->get_integer_parameter("pushing-iteration-limit", 20))
       , limit(ctx->get_integer_parameter("limit", 1000))
       , w(ctx->get_integer_parameter("w", 500))
+      , kappa_stall(ctx->get_integer_parameter("kappa-stall", 50))
+      , local_search_limit(
+          ctx->get_integer_parameter("local-search-limit", 100))
+      , local_search_tabu(ctx->get_integer_parameter("local-search-tabu", 0))
       , print_level(ctx->get_integer_parameter("print-level", 0))
       , order(get_constraint_order(ctx))
       , float_type(get_floating_point_type(ctx))
+      , preference_matrix(get_preference_matrix_type(ctx))
       , init_policy(get_init_policy_type(ctx))
+      , kappa_policy(get_kappa_policy_type(ctx))
+      , local_search(get_local_search_type(ctx))
+      , portfolio(get_portfolio_type(ctx))
     {
         if (limit < 0)
             limit = std::numeric_limits<int>::max();
 
+        if (kappa_stall <= 0)
+            kappa_stall = 1;
+
         info(ctx,
              " * Global parameters:\n"
              "  - limit: {}\n"
              "  - time-limit: {:.10g}\n"
+             "  - progress-period: {:.10g}\n"
              "  - floating-point-type: {}\n"
+             "  - preference-matrix-type: {}\n"
              "  - print-level: {}\n",
              limit,
              time_limit,
+             progress_period,
              floating_point_type_to_string(float_type),
+             preference_matrix_type_to_string(preference_matrix),
              print_level);
 
         info(ctx,
@@ -210,6 +363,8 @@ struct parameters
              "  - theta: {:.10g}\n"
              "  - delta: {:.10g}\n"
              "  - kappa: {:.10g} {:.10g} {:.10g}\n"
+             "  - kappa-policy: {}\n"
+             "  - kappa-stall: {}\n"
              "  - alpha: {:.10g}\n"
              "  - w: {}\n"
              "  - norm: {}\n",
@@ -220,6 +375,8 @@ struct parameters
              kappa_min,
              kappa_step,
              kappa_max,
+             kappa_policy_type_to_string(kappa_policy),
+             kappa_stall,
              alpha,
              w,
              norm);
@@ -241,11 +398,23 @@ struct parameters
              "  - init-random: {:.10g}\n",
              init_policy_type_to_string(init_policy),
              init_random);
+
+        info(ctx,
+             " * Optimizer parameters:\n"
+             "  - portfolio: {}\n"
+             "  - local-search: {}\n"
+             "  - local-search-limit: {}\n"
+             "  - local-search-tabu: {}\n",
+             portfolio_type_to_string(portfolio),
+             local_search_type_to_string(local_search),
+             local_search_limit,
+             local_search_tabu);
     }
 
     std::string preprocessing;
     std::string norm;
     double time_limit;
+    double progress_period;
     double theta;
     double delta;
     double kappa_min;
@@ -260,10 +429,384 @@ struct parameters
     int pushing_iteration_limit;
     int limit;
     int w;
+    int kappa_stall;
+    int local_search_limit;
+    int local_search_tabu;
     int print_level;
     constraint_order order;
     floating_point_type float_type;
+    preference_matrix_type preference_matrix;
     init_policy_type init_policy;
+    kappa_policy_type kappa_policy;
+    local_search_type local_search;
+    portfolio_type portfolio;
+};
+
+/**
+ * @brief Computes the @c kappa of the in the middle heuristic and decides
+ *     when a run is exhausted and must be restarted.
+ *
+ * @details After @c w iterations, the @c default policy increases @c kappa
+ *     by @c kappa-step * (remaining / m) ^ alpha and a run is exhausted when
+ *     @c kappa reaches @c kappa-max.
+ *
+ *     The @c adaptive policy scales this step with a factor in [1/2, 4]:
+ *     the factor is halved each time the number of remaining constraints
+ *     reaches a new minimum to avoid an overshoot of @c kappa, and doubled
+ *     when no new minimum is found since @c kappa-stall iterations, twice as
+ *     often if the number of remaining constraints oscillates. A run is also
+ *     restarted by the optimizer after 8 * @c kappa-stall iterations
+ *     without new minimum.
+ */
+template<typename floatingpointT>
+class kappa_controller
+{
+public:
+    kappa_controller(const parameters& p) noexcept
+      : m_kappa_min(static_cast<floatingpointT>(p.kappa_min))
+      , m_kappa_step(static_cast<floatingpointT>(p.kappa_step))
+      , m_kappa_max(static_cast<floatingpointT>(p.kappa_max))
+      , m_alpha(p.alpha)
+      , m_w(p.w)
+      , m_stall_limit(p.kappa_stall)
+      , m_policy(p.kappa_policy)
+    {
+        reset();
+    }
+
+    void assign(const parameters& p) noexcept
+    {
+        *this = kappa_controller(p);
+    }
+
+    void reset() noexcept
+    {
+        m_kappa = m_kappa_min;
+        m_factor = 1;
+        m_oscillation = 0;
+        m_best = std::numeric_limits<int>::max();
+        m_previous = -1;
+        m_stall = 0;
+        m_since_adjust = 0;
+        m_rising = false;
+    }
+
+    floatingpointT kappa() const noexcept
+    {
+        return m_kappa;
+    }
+
+    floatingpointT update(int i, int remaining, int m) noexcept
+    {
+        if (m_policy == kappa_policy_type::adaptive)
+            observe(remaining);
+
+        if (i > m_w) {
+            auto step = m_kappa_step *
+                        std::pow(static_cast<floatingpointT>(remaining) /
+                                   static_cast<floatingpointT>(m),
+                                 m_alpha);
+
+            m_kappa += m_policy == kappa_policy_type::adaptive
+                         ? step * m_factor
+                         : step;
+        }
+
+        return m_kappa;
+    }
+
+    bool exhausted() const noexcept
+    {
+        return m_kappa > m_kappa_max;
+    }
+
+    bool restart() const noexcept
+    {
+        if (exhausted())
+            return true;
+
+        return m_policy == kappa_policy_type::adaptive and
+               m_stall >= 8 * m_stall_limit;
+    }
+
+private:
+    void observe(int remaining) noexcept
+    {
+        if (m_previous >= 0 and remaining != m_previous) {
+            bool rising = remaining > m_previous;
+            m_oscillation *= floatingpointT(0.9);
+            if (rising != m_rising)
+                m_oscillation += floatingpointT(0.1);
+            m_rising = rising;
+        }
+        m_previous = remaining;
+
+        if (remaining < m_best) {
+            m_best = remaining;
+            m_stall = 0;
+            m_since_adjust = 0;
+            m_factor = std::max(m_factor / 2, floatingpointT(0.5));
+            return;
+        }
+
+        ++m_stall;
+        ++m_since_adjust;
+
+        auto limit = m_oscillation > floatingpointT(0.5)
+                       ? std::max(m_stall_limit / 2, 1)
+                       : m_stall_limit;
+
+        if (m_since_adjust >= limit) {
+            m_since_adjust = 0;
+            m_factor = std::min(m_factor * 2, floatingpointT(4));
+        }
+    }
+
+    floatingpointT m_kappa_min;
+    floatingpointT m_kappa_step;
+    floatingpointT m_kappa_max;
+    floatingpointT m_kappa;
+    floatingpointT m_factor;
+    floatingpointT m_oscillation;
+    double m_alpha;
+    int m_w;
+    int m_stall_limit;
+    int m_best;
+    int m_previous;
+    int m_stall;
+    int m_since_adjust;
+    kappa_policy_type m_policy;
+    bool m_rising;
+};
+
+/**
+ * @brief A set of configurations raced by the optimizer threads.
+ *
+ * @details Each configuration is a copy of the global @c parameters where
+ *     some parameters (@c theta, @c delta, @c kappa-*, @c alpha, @c w,
+ *     @c constraint-order, @c init-policy, @c norm etc.) are replaced. The
+ *     configurations come from a built-in diversified list or from the
+ *     @c portfolio-file file, one configuration per line with a list of
+ *     @c name=value separated by spaces.
+ *
+ *     Threads start with different configurations. At each restart, a
+ *     thread reports the best result of its configuration and @c next()
+ *     reassigns it: untried configurations first, then the configuration
+ *     with the best incumbent or, with a small probability, a random one.
+ */
+class portfolio
+{
+public:
+    portfolio(const std::shared_ptr<context>& ctx,
+              const parameters& p,
+              bool minimize,
+              unsigned seed);
+
+    int size() const noexcept
+    {
+        return static_cast<int>(m_configurations.size());
+    }
+
+    const parameters& configuration(int id) const noexcept
+    {
+        return m_configurations[id];
+    }
+
+    /**
+     * @brief Assigns a configuration to a starting thread: @c configuration
+     *     if it is valid (a thread resumed from a checkpoint), otherwise a
+     *     configuration chosen from the thread identifier.
+     */
+    int assign(int thread, int configuration = -1);
+
+    int next(int configuration, int remaining_constraints, double value);
+
+private:
+    struct score
+    {
+        double value = 0.0;
+        int remaining_constraints = std::numeric_limits<int>::max();
+        int runs = 0;
+        int running = 0;
+    };
+
+    bool is_better(const score& lhs, const score& rhs) const noexcept;
+
+    std::vector<parameters> m_configurations;
+    std::vector<score> m_scores;
+    std::mutex m_mutex;
+    std::mt19937 m_rng;
+    bool m_minimize;
+};
+
+class renumbering;
+
+/**
+ * @brief Merges the progress of the components of a decomposed problem.
+ *
+ * @details The components solved at the same time share the merger: its
+ *     mutex serializes the calls to the callback and each report of a
+ *     component updates its variables in the solution of the whole problem.
+ *     The variable @c j of the component @c c is the variable
+ *     @c variables[c][j] of the whole problem. The value and the remaining
+ *     constraints are the sums of the last reports of the components, a
+ *     component without report counts all its constraints as remaining.
+ */
+class progress_merger
+{
+public:
+    progress_merger(const std::vector<std::vector<int>>& variables,
+                    std::vector<int> constraints,
+                    std::size_t size)
+      : m_variables(variables)
+      , m_x(size, 0)
+      , m_value(variables.size(), 0.0)
+      , m_remaining(std::move(constraints))
+    {}
+
+    std::mutex& mutex() noexcept
+    {
+        return m_mutex;
+    }
+
+    // The caller holds the mutex.
+    void report(const context& ctx,
+                int component,
+                progress p,
+                const std::vector<std::int8_t>& x)
+    {
+        const auto& variables = m_variables[component];
+        for (std::size_t i = 0, e = std::min(x.size(), variables.size());
+             i != e;
+             ++i)
+            m_x[variables[i]] = x[i];
+
+        m_value[component] = p.value;
+        m_remaining[component] = p.remaining_constraints;
+
+        p.value = 0.0;
+        p.remaining_constraints = 0;
+        for (std::size_t c = 0, e = m_value.size(); c != e; ++c) {
+            p.value += m_value[c];
+            p.remaining_constraints += m_remaining[c];
+        }
+
+        p.x = m_x.data();
+        p.size = m_x.size();
+
+        ctx.progress_callback()(p);
+    }
+
+private:
+    const std::vector<std::vector<int>>& m_variables;
+    std::mutex m_mutex;
+    std::vector<std::int8_t> m_x;
+    std::vector<double> m_value;
+    std::vector<int> m_remaining;
+};
+
+/**
+ * @brief The component @c index of a decomposed problem and the merger of
+ *     the progress of all the components.
+ */
+struct progress_component
+{
+    progress_merger* merger;
+    int index;
+};
+
+/**
+ * @brief Forwards the improvements of a solver to the @c context progress
+ *     callback.
+ *
+ * @details At most one call per @c period seconds is made by a reporter.
+ *     An improvement found in between is kept pending and sent by a next
+ *     call to @c flush. Reporters of the same optimization share a mutex to
+ *     serialize the calls to the callback. If the solver renumbers the
+ *     variables, the solution is sent back in the problem order. The
+ *     reporter of a component sends the merged progress of the whole
+ *     problem, its mutex is the mutex of the merger.
+ */
+class progress_reporter
+{
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    progress_reporter(std::shared_ptr<context> ctx,
+                      std::mutex& mutex,
+                      int thread,
+                      double period,
+                      const renumbering* renumber = nullptr,
+                      const progress_component* component = nullptr)
+      : m_ctx(std::move(ctx))
+      , m_mutex(mutex)
+      , m_renumber(renumber)
+      , m_component(component)
+      , m_period(
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(period > 0 ? period : 0)))
+    {
+        m_progress.thread = thread;
+    }
+
+    void improve(double value, int remaining_constraints, double duration)
+    {
+        m_progress.value = value;
+        m_progress.remaining_constraints = remaining_constraints;
+        m_progress.duration = duration;
+        m_pending = true;
+    }
+
+    template<typename xT>
+    void flush(time_point now, const xT& x, bool force = false)
+    {
+        if (not m_pending or not m_ctx->progress_callback())
+            return;
+
+        if (not force and m_sent and now - m_last < m_period)
+            return;
+
+        // The solution is copied one value per variable, the solver may
+        // store it packed.
+
+        m_x.resize(x.size());
+        for (std::size_t i = 0, e = x.size(); i != e; ++i)
+            m_x[i] = static_cast<std::int8_t>(x[i]);
+
+        restore_order();
+
+        if (m_component) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_component->merger->report(
+              *m_ctx, m_component->index, m_progress, m_x);
+        } else {
+            m_progress.x = m_x.data();
+            m_progress.size = m_x.size();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ctx->progress_callback()(m_progress);
+        }
+
+        m_progress.x = nullptr;
+        m_progress.size = 0;
+        m_pending = false;
+        m_sent = true;
+        m_last = now;
+    }
+
+private:
+    void restore_order();
+
+    std::shared_ptr<context> m_ctx;
+    std::mutex& m_mutex;
+    const renumbering* m_renumber;
+    const progress_component* m_component;
+    progress m_progress;
+    std::vector<std::int8_t> m_x;
+    std::chrono::steady_clock::duration m_period;
+    time_point m_last;
+    bool m_pending = false;
+    bool m_sent = false;
 };
 
 struct merged_constraint
@@ -288,6 +831,128 @@ std::vector<merged_constraint>
 make_merged_constraints(const std::shared_ptr<context>& ctx,
                         const problem& pb,
                         const parameters& p);
+
+/**
+ * @brief Renumbering of the rows and the variables of the merged constraints
+ *     for the memory locality of the solver.
+ *
+ * @details The @c reorder parameter selects the renumbering: @c none
+ *     (default) keeps the order of the problem, @c rcm renumbers constraints
+ *     and variables with a reverse Cuthill-McKee ordering of the bipartite
+ *     graph of the constraint matrix and @c rcm-variables renumbers only the
+ *     variables, the constraints keep the @c preprocessing order. Variables
+ *     close in a constraint get close indices, the column walks and the row
+ *     updates of the solver touch close memory.
+ *
+ *     The constructor renumbers @c csts in place. Vectors indexed by the
+ *     variables of the problem (costs, names) are renumbered with @c apply()
+ *     before the solver construction and the vectors of the solver results
+ *     are restored in the problem order with @c restore().
+ */
+class renumbering
+{
+public:
+    renumbering(const std::shared_ptr<context>& ctx,
+                std::vector<merged_constraint>& csts,
+                int variables);
+
+    bool empty() const noexcept
+    {
+        return m_variables.empty();
+    }
+
+    /**
+     * @brief The index in the solver of the variable @c original.
+     */
+    int variable(int original) const noexcept
+    {
+        return empty() ? original : m_index[original];
+    }
+
+    template<typename Container>
+    void apply(Container& v) const
+    {
+        if (empty() or v.size() != m_variables.size())
+            return;
+
+        Container copy(v);
+        for (std::size_t i = 0, e = m_variables.size(); i != e; ++i)
+            v[i] = copy[m_variables[i]];
+    }
+
+    template<typename Container>
+    void restore(Container& v) const
+    {
+        if (empty() or v.size() != m_variables.size())
+            return;
+
+        Container copy(v);
+        for (std::size_t i = 0, e = m_variables.size(); i != e; ++i)
+            v[m_variables[i]] = copy[i];
+    }
+
+private:
+    std::vector<int> m_variables; // solver index -> problem index
+    std::vector<int> m_index;     // problem index -> solver index
+};
+
+inline void
+progress_reporter::restore_order()
+{
+    if (m_renumber)
+        m_renumber->restore(m_x);
+}
+
+/**
+ * @brief Placement of the optimizer threads on the CPUs and NUMA nodes.
+ *
+ * @details The @c thread-affinity parameter selects the placement: @c none
+ *     (default) lets the system schedule the threads, @c compact fills the
+ *     CPUs of a NUMA node before the next one and @c scatter distributes the
+ *     threads round-robin over the NUMA nodes. Nodes and CPUs are read from
+ *     @c /sys/devices/system/node and restricted to the CPUs available to
+ *     the process. Pinning is available on Linux only, elsewhere all the
+ *     threads run on one node and @c pin does nothing.
+ *
+ *     A thread pinned before it allocates its solver first-touches its
+ *     memory on its own node. With @c numa-replicate, the optimizer also
+ *     builds one copy of the read-only solver structure per node.
+ */
+class thread_placement
+{
+public:
+    thread_placement(const std::shared_ptr<context>& ctx, int thread);
+
+    bool enabled() const noexcept
+    {
+        return not m_cpus.empty();
+    }
+
+    bool replicate() const noexcept
+    {
+        return m_replicate and nodes() > 1;
+    }
+
+    int nodes() const noexcept
+    {
+        return m_node_cpus.empty() ? 1 : static_cast<int>(m_node_cpus.size());
+    }
+
+    int node(int thread) const noexcept
+    {
+        return enabled() ? m_nodes[thread] : 0;
+    }
+
+    void pin(int thread) const noexcept;
+
+    void pin_node(int node) const noexcept;
+
+private:
+    std::vector<std::vector<int>> m_node_cpus;
+    std::vector<int> m_cpus;
+    std::vector<int> m_nodes;
+    bool m_replicate = false;
+};
 }
 }
 
@@ -0,0 +1,274 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ORG_VLEPROJECT_BARYONYX_SOLVER_LOCAL_SEARCH_HPP
+#define ORG_VLEPROJECT_BARYONYX_SOLVER_LOCAL_SEARCH_HPP
+
+#include "fixed_array.hpp"
+#include "private.hpp"
+
+#include <tuple>
+
+namespace baryonyx {
+namespace details {
+
+/**
+ * @brief Feasibility-preserving local search to polish a 0-1 solution.
+ *
+ * @details Starting from a feasible solution, the local search applies the
+ *     best improving 1-flip move or, if no flip improves the objective, the
+ *     first improving 2-swap move (a variable from 1 to 0 and a variable from
+ *     0 to 1 sharing a constraint). The row activities are updated
+ *     incrementally and each move is evaluated along the columns of the
+ *     sparse matrix. With a tabu tenure greater than 0, non-worsening moves
+ *     are also accepted and a flipped variable stays fixed during tenure
+ *     moves.
+ */
+template<typename modeT, typename floatingpointT>
+class local_search
+{
+public:
+    local_search(int m, int n)
+      : m_activity(m, 0)
+      , m_tabu(n, 0)
+    {}
+
+    /**
+     * @brief Polishes the solution @c x in place.
+     *
+     * @return true if the objective function of @c x is improved.
+     */
+    template<typename apT, typename bT, typename xT, typename cT>
+    bool run(const apT& ap,
+             const bT& b,
+             xT& x,
+             const cT& c,
+             int limit,
+             int tenure,
+             bool swap)
+    {
+        compute_activities(ap, x);
+
+        for (auto& elem : m_tabu)
+            elem = 0;
+
+        floatingpointT total = 0;
+
+        for (int it = 1; it <= limit; ++it) {
+            int j = -1, l = -1;
+            floatingpointT gain = 0;
+
+            std::tie(j, gain) = best_flip(ap, b, x, c, it);
+
+            if (j < 0 and swap)
+                std::tie(j, l, gain) = first_swap(ap, b, x, c, it, false);
+
+            if (j < 0 and tenure > 0) {
+                std::tie(j, gain) = best_flip(ap, b, x, c, it, true);
+
+                if (j < 0 and swap)
+                    std::tie(j, l, gain) = first_swap(ap, b, x, c, it, true);
+            }
+
+            if (j < 0)
+                break;
+
+            flip(ap, x, j);
+            m_tabu[j] = it + tenure;
+
+            if (l >= 0) {
+                flip(ap, x, l);
+                m_tabu[l] = it + tenure;
+            }
+
+            total += gain;
+        }
+
+        return total > 0;
+    }
+
+private:
+    fixed_array<int> m_activity;
+    fixed_array<int> m_tabu;
+
+    static floatingpointT gain(floatingpointT cost, int d, minimize_tag)
+    {
+        return -cost * d;
+    }
+
+    static floatingpointT gain(floatingpointT cost, int d, maximize_tag)
+    {
+        return cost * d;
+    }
+
+    template<typename xT>
+    static int direction(const xT& x, int j) noexcept
+    {
+        return x[j] ? -1 : 1;
+    }
+
+    template<typename apT, typename xT>
+    void compute_activities(const apT& ap, const xT& x)
+    {
+        typename apT::const_iterator it, et;
+
+        for (int k = 0, e = static_cast<int>(m_activity.size()); k != e; ++k) {
+            std::tie(it, et) = ap.row(k);
+            int v = 0;
+
+            for (; it != et; ++it)
+                v += ap.A()[it->value] * x[it->position];
+
+            m_activity[k] = v;
+        }
+    }
+
+    template<typename apT, typename xT>
+    void flip(const apT& ap, xT& x, int j)
+    {
+        typename apT::const_iterator it, et;
+        std::tie(it, et) = ap.column(j);
+
+        const int d = direction(x, j);
+
+        for (; it != et; ++it)
+            m_activity[it->position] += ap.A()[it->value] * d;
+
+        x[j] = x[j] ? 0 : 1;
+    }
+
+    template<typename apT, typename bT>
+    bool is_feasible(const apT& ap, const bT& b, int j) const
+    {
+        typename apT::const_iterator it, et;
+        std::tie(it, et) = ap.column(j);
+
+        for (; it != et; ++it) {
+            const int v = m_activity[it->position];
+
+            if (v < b(it->position).min or b(it->position).max < v)
+                return false;
+        }
+
+        return true;
+    }
+
+    template<typename apT, typename bT, typename xT>
+    bool is_flip_feasible(const apT& ap, const bT& b, const xT& x, int j) const
+    {
+        typename apT::const_iterator it, et;
+        std::tie(it, et) = ap.column(j);
+
+        const int d = direction(x, j);
+
+        for (; it != et; ++it) {
+            const int v = m_activity[it->position] + ap.A()[it->value] * d;
+
+            if (v < b(it->position).min or b(it->position).max < v)
+                return false;
+        }
+
+        return true;
+    }
+
+    template<typename apT, typename bT, typename xT, typename cT>
+    std::tuple<int, floatingpointT> best_flip(const apT& ap,
+                                              const bT& b,
+                                              const xT& x,
+                                              const cT& c,
+                                              int iteration,
+                                              bool plateau = false) const
+    {
+        int best = -1;
+        floatingpointT best_gain = 0;
+
+        for (int j = 0, e = static_cast<int>(m_tabu.size()); j != e; ++j) {
+            if (m_tabu[j] >= iteration)
+                continue;
+
+            auto g = gain(c[j], direction(x, j), modeT());
+            if (g < best_gain or (g == best_gain and (best >= 0 or
+                                                      not plateau)))
+                continue;
+
+            if (is_flip_feasible(ap, b, x, j)) {
+                best = j;
+                best_gain = g;
+            }
+        }
+
+        return std::make_tuple(best, best_gain);
+    }
+
+    template<typename apT, typename bT, typename xT, typename cT>
+    std::tuple<int, int, floatingpointT> first_swap(const apT& ap,
+                                                    const bT& b,
+                                                    xT& x,
+                                                    const cT& c,
+                                                    int iteration,
+                                                    bool plateau)
+    {
+        typename apT::const_iterator cit, cet, rit, ret;
+
+        for (int j = 0, e = static_cast<int>(m_tabu.size()); j != e; ++j) {
+            if (x[j] == 0 or m_tabu[j] >= iteration)
+                continue;
+
+            const auto gj = gain(c[j], -1, modeT());
+
+            for (std::tie(cit, cet) = ap.column(j); cit != cet; ++cit) {
+                for (std::tie(rit, ret) = ap.row(cit->position); rit != ret;
+                     ++rit) {
+                    const int l = rit->position;
+                    if (x[l] == 1 or m_tabu[l] >= iteration)
+                        continue;
+
+                    const auto g = gj + gain(c[l], 1, modeT());
+                    if (g < 0 or (g == 0 and not plateau))
+                        continue;
+
+                    // Applies the two flips on the row activities, checks
+                    // the constraints of both columns then reverts.
+
+                    flip(ap, x, j);
+                    flip(ap, x, l);
+
+                    const bool feasible =
+                      is_feasible(ap, b, j) and is_feasible(ap, b, l);
+
+                    flip(ap, x, l);
+                    flip(ap, x, j);
+
+                    if (feasible)
+                        return std::make_tuple(j, l, g);
+                }
+            }
+        }
+
+        return std::make_tuple(-1, -1, floatingpointT(0));
+    }
+};
+
+} // namespace details
+} // namespace baryonyx
+
+#endif
@@ -22,6 +22,7 @@
 
 #include <baryonyx/core>
 
+#include "async-logger.hpp"
 #include "private.hpp"
 #include "utils.hpp"
 
@@ -140,24 +141,51 @@ help(baryonyx::context* ctx) noexcept
       "feasibility search only)\n"
       "  --check filename.sol        Check if the solution is correct."
       "\n"
+      "  --resume checkpoint         Resume an optimization from its "
+      "checkpoints\n"
       "  --quiet                     Remove any verbose message\n"
-      "  --verbose|-v int            Set verbose level\n\n"
+      "  --sol-sparse                Write only nonzero variables in "
+      "solutions\n"
+      "  --sol-binary                Write solutions in binary format\n"
+      "  --verbose|-v int            Set verbose level\n"
+      "  --async-log                 Write log messages from a dedicated "
+      "thread\n\n"
       "Parameter list for in the middle heuristic\n"
       " * Global parameters"
       "  - limit: integer ]-oo, +oo[ in loop number\n"
       "  - time-limit: real [0, +oo[ in seconds\n"
+      "  - progress-period: real [0, +oo[ in seconds\n"
       "  - floating-point-type: float double longdouble\n"
+      "  - preference-matrix-type: default float bfloat16\n"
+      "  - memory-limit: real [0, +oo[ in MiB, reduces threads then "
+      "precision\n"
       "  - print-level: [0, 2]\n"
+      "  - race: integer [0, 1] solve on all threads, first feasible "
+      "wins\n"
+      "  - decomposition: integer [0, 1] solve independent components in "
+      "parallel\n"
+      "  - active-set-period: integer [0, +oo[ iterations between two "
+      "checks of all the constraints, 0 checks all at each iteration\n"
+      "  - active-set-margin: integer [0, +oo[ slack of the constraints "
+      "kept active\n"
+      "  - parse-thread: integer [1, +oo[ threads reading constraints\n"
+      "  - integer-domain-limit: integer [1, +oo[ values per general "
+      "variable\n"
       " * In The Middle parameters\n"
       "  - preprocessing: none variables-number variables-weight "
       "constraints-weight implied\n"
+      "  - presolve: none reduce probing\n"
+      "  - presolve-probing-limit: integer [0, +oo[ in variables\n"
       "  - constraint-order: none reversing random-sorting "
       "infeasibility-decr infeasibility-incr\n"
+      "  - reorder: none rcm rcm-variables\n"
       "  - theta: real [0, 1]\n"
       "  - delta: real [0, +oo[\n"
       "  - kappa-min: real [0, 1[\n"
       "  - kappa-step: real [0, 1[\n"
       "  - kappa-max: real [0, 1[\n"
+      "  - kappa-policy: default adaptive\n"
+      "  - kappa-stall: integer [1, +oo[\n"
       "  - alpha: integer [0, 2]\n"
       "  - w: integer [0, +oo[\n"
       "  - norm: l1 l2 inf none rng\n"
@@ -167,8 +195,21 @@ help(baryonyx::context* ctx) noexcept
       "  - pushing-iteration-limit: integer [0, +oo[\n"
       "  - pushing-k-factor: real [0, +oo[\n"
       " * Initialization parameters\n"
-      "  - init-policy: bastert random best\n"
-      "  - init-random: real [0, 1]\n");
+      "  - init-policy: bastert random best file\n"
+      "  - init-solution: string solution file read by init-policy=file\n"
+      "  - init-random: real [0, 1]\n"
+      " * Optimizer parameters\n"
+      "  - portfolio: none builtin file\n"
+      "  - portfolio-file: file with one configuration per line "
+      "(name=value ...)\n"
+      "  - local-search: none flip swap\n"
+      "  - local-search-limit: integer [0, +oo[ in moves\n"
+      "  - local-search-tabu: integer [0, +oo[ in moves\n"
+      "  - thread-affinity: none compact scatter\n"
+      "  - numa-replicate: integer [0, 1] copy the structure per node\n"
+      "  - checkpoint: string path of the checkpoints of the threads\n"
+      "  - checkpoint-period: real [0, +oo[ in seconds between two "
+      "checkpoints\n");
 }
 }
 
@@ -193,15 +234,51 @@ context::context(string_logger_functor logger)
   , m_logger(context::logger_type::string)
 {}
 
+context::~context() noexcept = default;
+
+void
+context::set_async_logging(bool enable)
+{
+    if (enable == async_logging())
+        return;
+
+    if (enable)
+        m_async_logger = std::make_unique<async_logger>(
+          m_logger == logger_type::c_file ? m_cfile_logger : nullptr,
+          m_string_logger);
+    else
+        m_async_logger.reset();
+}
+
+void
+context::push_log(message_type type, std::string msg)
+{
+    if (m_async_logger)
+        m_async_logger->push(type, std::move(msg));
+    else if (m_logger == logger_type::c_file)
+        std::fwrite(msg.data(), 1, msg.size(), m_cfile_logger);
+    else
+        m_string_logger(type, std::move(msg));
+}
+
+void
+context::flush_log() noexcept
+{
+    if (m_async_logger)
+        m_async_logger->flush();
+}
+
 int
 context::parse(int argc, char* argv[]) noexcept
 {
     const char* const short_opts = "OC:hp:l:qv:";
     const struct option long_opts[] = {
-        { "optimize", 0, nullptr, 'O' }, { "check", 1, nullptr, 'C' },
-        { "help", 0, nullptr, 'h' },     { "param", 1, nullptr, 'p' },
-        { "limit", 1, nullptr, 'l' },    { "quiet", 0, nullptr, 'q' },
-        { "verbose", 1, nullptr, 'v' },  { nullptr, 0, nullptr, 0 }
+        { "optimize", 0, nullptr, 'O' },   { "check", 1, nullptr, 'C' },
+        { "help", 0, nullptr, 'h' },       { "param", 1, nullptr, 'p' },
+        { "limit", 1, nullptr, 'l' },      { "quiet", 0, nullptr, 'q' },
+        { "verbose", 1, nullptr, 'v' },    { "sol-sparse", 0, nullptr, 's' },
+        { "sol-binary", 0, nullptr, 'b' }, { "resume", 1, nullptr, 'r' },
+        { "async-log", 0, nullptr, 'a' },  { nullptr, 0, nullptr, 0 }
     };
 
     int opt_index;
@@ -224,6 +301,10 @@ context::parse(int argc, char* argv[]) noexcept
         case 'O':
             m_optimize = true;
             break;
+        case 'r':
+            m_optimize = true;
+            m_parameters["resume"] = std::string(::optarg);
+            break;
         case 'h':
             ::help(this);
             break;
@@ -242,6 +323,15 @@ context::parse(int argc, char* argv[]) noexcept
         case 'v':
             verbose = ::to_int(::optarg, 3);
             break;
+        case 'a':
+            set_async_logging(true);
+            break;
+        case 's':
+            m_parameters["sol-sparse"] = 1;
+            break;
+        case 'b':
+            m_parameters["sol-format"] = std::string("binary");
+            break;
         case '?':
         default:
             baryonyx::log(this,
@@ -372,7 +462,8 @@ make_problem(const std::shared_ptr<baryonyx::context>& ctx,
     ifs.exceptions(std::ifstream::badbit);
     ifs.open(filename);
 
-    return baryonyx_private::read_problem(ifs);
+    return baryonyx_private::read_problem(
+      ifs, ctx->get_integer_parameter("parse-thread", 1));
 }
 
 problem
@@ -382,7 +473,8 @@ make_problem(const std::shared_ptr<baryonyx::context>& ctx, std::istream& is)
 
     is.exceptions(std::ifstream::badbit);
 
-    return baryonyx_private::read_problem(is);
+    return baryonyx_private::read_problem(
+      is, ctx->get_integer_parameter("parse-thread", 1));
 }
 
 result
@@ -408,6 +500,16 @@ make_result(const std::shared_ptr<baryonyx::context>& ctx, std::istream& is)
     return baryonyx_private::read_result(is);
 }
 
+solution_report
+check_solution(const std::shared_ptr<baryonyx::context>& ctx,
+               const problem& pb,
+               const std::string& filename)
+{
+    info(ctx, "solution checks from file {}\n", filename);
+
+    return baryonyx_private::check_solution(ctx, pb, filename);
+}
+
 std::ostream&
 operator<<(std::ostream& os, const problem& p)
 {
@@ -417,12 +519,39 @@ operator<<(std::ostream& os, const problem& p)
     return os;
 }
 
+std::ostream&
+write_result(std::ostream& os,
+             const result& r,
+             result_format format,
+             bool sparse)
+{
+    baryonyx_private::write_result(
+      os, r, r.variable_name, r.affected_vars, format, sparse);
+
+    return os;
+}
+
+result_format
+get_result_format(const std::shared_ptr<context>& ctx)
+{
+    return baryonyx_private::get_result_format(ctx);
+}
+
+bool
+get_result_sparse(const std::shared_ptr<context>& ctx)
+{
+    return baryonyx_private::get_result_sparse(ctx);
+}
+
 result
 solve(std::shared_ptr<baryonyx::context> ctx, problem& pb)
 {
     baryonyx_private::check_consistency(pb);
 
-    return baryonyx_private::solve(ctx, pb);
+    auto ret = baryonyx_private::solve(ctx, pb);
+    ctx->flush_log();
+
+    return ret;
 }
 
 result
@@ -430,7 +559,10 @@ optimize(std::shared_ptr<baryonyx::context> ctx, problem& pb)
 {
     baryonyx_private::check_consistency(pb);
 
-    return baryonyx_private::optimize(std::move(ctx), pb);
+    auto ret = baryonyx_private::optimize(ctx, pb);
+    ctx->flush_log();
+
+    return ret;
 }
 
 template<typename functionT, typename variablesT>
@@ -497,12 +629,17 @@ make_variable_value(const problem& pb, const result& r)
       std::inserter(cache, cache.begin()),
       [](const auto& name, int value) { return std::make_pair(name, value); });
 
-    std::vector<int> ret(pb.vars.names.size(), INT_MAX);
+    // A sparse solution only stores the nonzero variables, the missing
+    // variables are equal to zero.
+
+    std::vector<int> ret(pb.vars.names.size(), 0);
 
     for (std::size_t i = 0, e = pb.vars.names.size(); i != e; ++i) {
         auto it = cache.find(pb.vars.names[i]);
-        Expects(it != cache.end());
-        ret[i] = it->second;
+        Expects(r.sparse or it != cache.end());
+
+        if (it != cache.end())
+            ret[i] = it->second;
     }
 
     return ret;
@@ -512,7 +649,7 @@ bool
 is_valid_solution(const problem& pb, const result& r)
 {
     Expects(pb.vars.names.size() == pb.vars.values.size());
-    Expects(pb.vars.names.size() == r.variable_name.size());
+    Expects(pb.vars.names.size() >= r.variable_name.size());
     Expects(r.variable_value.size() == r.variable_name.size());
     Expects(pb.affected_vars.names.empty());
     Expects(pb.affected_vars.values.empty());
@@ -526,7 +663,7 @@ double
 compute_solution(const problem& pb, const result& r)
 {
     Expects(pb.vars.names.size() == pb.vars.values.size());
-    Expects(pb.vars.names.size() == r.variable_name.size());
+    Expects(pb.vars.names.size() >= r.variable_name.size());
     Expects(r.variable_value.size() == r.variable_name.size());
     Expects(pb.affected_vars.names.empty());
     Expects(pb.affected_vars.values.empty());
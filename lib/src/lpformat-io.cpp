@@ -26,10 +26,16 @@
 
 #include "utils.hpp"
 
+#include <algorithm>
 #include <deque>
+#include <exception>
 #include <istream>
+#include <iterator>
 #include <limits>
 #include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <thread>
 #include <unordered_map>
 
 using namespace baryonyx;
@@ -87,10 +93,10 @@ is_valid_character(int c) noexcept
 
 struct parser_stack
 {
-    parser_stack(std::istream& is_)
+    parser_stack(std::istream& is_, int line_ = 0)
       : m_is(is_)
       , m_current_constraint_id(0)
-      , m_line(0)
+      , m_line(line_)
       , m_column(0)
       , m_eof_reached(is_.eof())
     {}
@@ -178,7 +184,7 @@ struct parser_stack
             return true;
         }
 
-        if (stack.size() >= 2 and
+        if (stack.size() > 2 and
             (iequals(stack[0], "subject") and iequals(stack[1], "to") and
              iequals(stack[2], ":"))) {
             pop();
@@ -761,6 +767,35 @@ read_constraint(parser_stack& stack, problem& p)
       file_format_error_tag::bad_constraint, stack.line(), stack.column());
 }
 
+static inline void
+push_constraint(parser_stack& stack,
+                problem& p,
+                std::tuple<constraint, operator_type>& cst)
+{
+    std::get<0>(cst).id = stack.current_constraint_id();
+
+    switch (std::get<1>(cst)) {
+    case operator_type::equal:
+        p.equal_constraints.emplace_back(std::get<0>(cst));
+        break;
+    case operator_type::greater:
+        p.greater_constraints.emplace_back(std::get<0>(cst));
+        break;
+    case operator_type::less:
+        p.less_constraints.emplace_back(std::get<0>(cst));
+        break;
+    default:
+        throw file_format_failure(
+          file_format_error_tag::unknown, stack.line(), stack.column());
+    }
+
+    if (std::get<0>(cst).label.empty())
+        std::get<0>(cst).label =
+          fmt::format("ct{}", stack.current_constraint_id());
+
+    stack.increase_current_constaint_id();
+}
+
 static inline void
 read_constraints(parser_stack& stack, problem& p)
 {
@@ -771,28 +806,8 @@ read_constraints(parser_stack& stack, problem& p)
            not iequals(str, "general") and not iequals(str, "end")) {
 
         auto cst = read_constraint(stack, p);
-        std::get<0>(cst).id = stack.current_constraint_id();
-
-        switch (std::get<1>(cst)) {
-        case operator_type::equal:
-            p.equal_constraints.emplace_back(std::get<0>(cst));
-            break;
-        case operator_type::greater:
-            p.greater_constraints.emplace_back(std::get<0>(cst));
-            break;
-        case operator_type::less:
-            p.less_constraints.emplace_back(std::get<0>(cst));
-            break;
-        default:
-            throw file_format_failure(
-              file_format_error_tag::unknown, stack.line(), stack.column());
-        }
-
-        if (std::get<0>(cst).label.empty())
-            std::get<0>(cst).label =
-              fmt::format("ct{}", stack.current_constraint_id());
+        push_constraint(stack, p, cst);
 
-        stack.increase_current_constaint_id();
         str = stack.top();
     }
 }
@@ -929,6 +944,287 @@ read_general(parser_stack& stack, problem& p)
     }
 }
 
+//
+// Parallel reader: the constraints section (between the `subject to' and the
+// bounds, binary, general or end keywords) is split into chunks at constraint
+// boundaries. Each chunk is read by a thread with its own variable table. The
+// tables are merged in file order so variable and constraint identifiers are
+// the same as the sequential reader.
+//
+
+struct lp_chunk
+{
+    std::string::size_type begin;
+    std::string::size_type end;
+    int line;
+    int constraints;
+    problem p;
+    std::exception_ptr error;
+};
+
+//
+// A read-only stream buffer over the range [begin, end) of the file buffer:
+// the chunks are parsed in place, without a copy of their text.
+//
+class range_streambuf : public std::streambuf
+{
+public:
+    range_streambuf(const std::string& buffer,
+                    std::string::size_type begin,
+                    std::string::size_type end)
+    {
+        auto* data = const_cast<char*>(buffer.data());
+        setg(data + begin, data + begin, data + end);
+    }
+};
+
+static inline bool
+is_section_end(const std::string& str) noexcept
+{
+    return iequals(str, "binary") or iequals(str, "binaries") or
+           iequals(str, "bound") or iequals(str, "bounds") or
+           iequals(str, "general") or iequals(str, "end");
+}
+
+//
+// Finds the byte position of the constraints section. Returns false if the
+// buffer has no constraint section.
+//
+static bool
+find_constraints_section(const std::string& buffer,
+                         std::string::size_type& begin,
+                         std::string::size_type& end)
+{
+    enum class state
+    {
+        objective,
+        st,
+        subject,
+        subject_to,
+        constraints
+    };
+
+    const auto size = buffer.size();
+    auto current = state::objective;
+    std::string::size_type i = 0;
+
+    while (i < size) {
+        auto line_end = buffer.find('\n', i);
+        if (line_end == std::string::npos)
+            line_end = size;
+
+        while (i < line_end and std::isspace(buffer[i]))
+            ++i;
+
+        if (i < line_end and buffer[i] == '\\')
+            i = line_end;
+
+        while (i < line_end) {
+            auto token_begin = i;
+            while (i < line_end and not std::isspace(buffer[i]))
+                ++i;
+
+            auto token = buffer.substr(token_begin, i - token_begin);
+
+            while (i < line_end and std::isspace(buffer[i]))
+                ++i;
+
+            switch (current) {
+            case state::objective:
+                if (iequals(token, "st:")) {
+                    current = state::constraints;
+                    begin = token_begin + token.size();
+                } else if (iequals(token, "st")) {
+                    current = state::st;
+                    begin = token_begin + token.size();
+                } else if (iequals(token, "subject")) {
+                    current = state::subject;
+                } else if (is_section_end(token)) {
+                    return false;
+                }
+                continue;
+            case state::subject:
+                if (not iequals(token, "to") and not iequals(token, "to:"))
+                    return false;
+                current = iequals(token, "to") ? state::subject_to
+                                               : state::constraints;
+                begin = token_begin + token.size();
+                continue;
+            case state::st:
+            case state::subject_to:
+                current = state::constraints;
+                if (token == ":") {
+                    begin = token_begin + token.size();
+                    continue;
+                }
+                break;
+            case state::constraints:
+                break;
+            }
+
+            if (is_section_end(token)) {
+                end = token_begin;
+                return true;
+            }
+        }
+
+        i = line_end + 1;
+    }
+
+    return false;
+}
+
+//
+// A line ends a constraint if its last operator is only followed by an
+// integer (the right hand side of the constraint).
+//
+static bool
+is_constraint_end(const std::string& buffer,
+                  std::string::size_type begin,
+                  std::string::size_type end) noexcept
+{
+    auto i = begin;
+    while (i < end and std::isspace(buffer[i]))
+        ++i;
+
+    if (i == end or buffer[i] == '\\')
+        return false;
+
+    auto op = buffer.find_last_of("<>=", end - 1);
+    if (op == std::string::npos or op < begin)
+        return false;
+
+    i = op + 1;
+    while (i < end and std::isspace(buffer[i]))
+        ++i;
+
+    if (i < end and (buffer[i] == '-' or buffer[i] == '+'))
+        ++i;
+
+    while (i < end and std::isspace(buffer[i]))
+        ++i;
+
+    if (i == end or not std::isdigit(buffer[i]))
+        return false;
+
+    while (i < end and std::isdigit(buffer[i]))
+        ++i;
+
+    while (i < end and std::isspace(buffer[i]))
+        ++i;
+
+    return i == end;
+}
+
+static std::vector<lp_chunk>
+split_constraints_section(const std::string& buffer,
+                          std::string::size_type begin,
+                          std::string::size_type end,
+                          int chunk_number)
+{
+    std::vector<lp_chunk> chunks;
+
+    auto line = std::count(buffer.begin(), buffer.begin() + begin, '\n');
+    const auto length = (end - begin) / chunk_number;
+    auto first = begin;
+
+    for (int i = 1; i <= chunk_number and first < end; ++i) {
+        auto last = end;
+
+        if (i < chunk_number) {
+            last = std::max(first, begin + i * length);
+
+            for (;;) {
+                auto line_begin = buffer.rfind('\n', last);
+                line_begin = (line_begin == std::string::npos or
+                              line_begin < first)
+                               ? first
+                               : line_begin + 1;
+
+                auto line_end = buffer.find('\n', last);
+                if (line_end == std::string::npos or line_end >= end) {
+                    last = end;
+                    break;
+                }
+
+                if (is_constraint_end(buffer, line_begin, line_end)) {
+                    last = line_end + 1;
+                    break;
+                }
+
+                last = line_end + 1;
+            }
+        }
+
+        chunks.emplace_back();
+        chunks.back().begin = first;
+        chunks.back().end = last;
+        chunks.back().line = static_cast<int>(line);
+        chunks.back().constraints = 0;
+
+        line += std::count(buffer.begin() + first, buffer.begin() + last, '\n');
+        first = last;
+    }
+
+    return chunks;
+}
+
+static void
+read_constraints_chunk(const std::string& buffer, lp_chunk& chunk) noexcept
+{
+    try {
+        range_streambuf range(buffer, chunk.begin, chunk.end);
+        std::istream is(&range);
+        parser_stack stack(is, chunk.line);
+
+        while (stack.peek() != EOF) {
+            auto cst = read_constraint(stack, chunk.p);
+            push_constraint(stack, chunk.p, cst);
+        }
+
+        chunk.constraints = stack.current_constraint_id();
+    } catch (...) {
+        chunk.error = std::current_exception();
+    }
+}
+
+static void
+merge_constraints(std::vector<constraint>& dst,
+                  std::vector<constraint>& src,
+                  const std::vector<int>& mapping,
+                  int offset)
+{
+    for (auto& cst : src) {
+        cst.id += offset;
+
+        for (auto& elem : cst.elements)
+            elem.variable_index = mapping[elem.variable_index];
+
+        dst.emplace_back(std::move(cst));
+    }
+}
+
+static inline void
+read_end_of_problem(parser_stack& stack, problem& p)
+{
+    if (stack.is_bounds())
+        read_bounds(stack, p);
+
+    if (stack.is_binary())
+        read_binary(stack, p);
+
+    if (stack.is_general())
+        read_general(stack, p);
+
+    if (stack.is_end()) {
+        if (stack.empty())
+            return;
+    }
+
+    throw file_format_failure(
+      "end", file_format_error_tag::incomplete, stack.line(), stack.column());
+}
+
 struct problem_writer
 {
     const problem& p;
@@ -1063,22 +1359,92 @@ read_problem(std::istream& is)
     if (stack.is_subject_to())
         read_constraints(stack, p);
 
-    if (stack.is_bounds())
-        read_bounds(stack, p);
+    read_end_of_problem(stack, p);
 
-    if (stack.is_binary())
-        read_binary(stack, p);
+    return p;
+}
 
-    if (stack.is_general())
-        read_general(stack, p);
+baryonyx::problem
+read_problem(std::istream& is, int thread)
+{
+    if (thread <= 1)
+        return read_problem(is);
 
-    if (stack.is_end()) {
-        if (stack.empty())
-            return p;
+    std::string buffer{ std::istreambuf_iterator<char>(is),
+                        std::istreambuf_iterator<char>() };
+
+    std::string::size_type begin, end;
+    if (not find_constraints_section(buffer, begin, end)) {
+        std::istringstream iss(buffer);
+        return read_problem(iss);
     }
 
-    throw file_format_failure(
-      "end", file_format_error_tag::incomplete, stack.line(), stack.column());
+    auto chunks = split_constraints_section(buffer, begin, end, thread);
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size());
+
+    for (std::size_t i = 1, e = chunks.size(); i < e; ++i)
+        workers.emplace_back(
+          read_constraints_chunk, std::cref(buffer), std::ref(chunks[i]));
+
+    problem p;
+    range_streambuf header_range(buffer, 0, begin);
+    std::istream header(&header_range);
+    parser_stack stack(header);
+
+    try {
+        p.type = read_objective_function_type(stack);
+        p.objective = read_objective_function(stack, p);
+
+        if (not stack.is_subject_to() or stack.peek() != EOF)
+            throw file_format_failure(file_format_error_tag::unknown,
+                                      stack.line(),
+                                      stack.column());
+    } catch (...) {
+        for (auto& worker : workers)
+            worker.join();
+
+        throw;
+    }
+
+    if (not chunks.empty())
+        read_constraints_chunk(buffer, chunks.front());
+
+    for (auto& worker : workers)
+        worker.join();
+
+    int offset = 0;
+    for (auto& chunk : chunks) {
+        if (chunk.error)
+            std::rethrow_exception(chunk.error);
+
+        std::vector<int> mapping(chunk.p.vars.names.size());
+        for (std::size_t i = 0, e = mapping.size(); i != e; ++i)
+            mapping[i] =
+              get_variable(stack.cache(), p.vars, chunk.p.vars.names[i]);
+
+        merge_constraints(
+          p.equal_constraints, chunk.p.equal_constraints, mapping, offset);
+        merge_constraints(
+          p.greater_constraints, chunk.p.greater_constraints, mapping, offset);
+        merge_constraints(
+          p.less_constraints, chunk.p.less_constraints, mapping, offset);
+
+        offset += chunk.constraints;
+        clear(chunk.p);
+    }
+
+    range_streambuf tail_range(buffer, end, buffer.size());
+    std::istream tail(&tail_range);
+    parser_stack tail_stack(
+      tail,
+      static_cast<int>(std::count(buffer.begin(), buffer.begin() + end, '\n')));
+    tail_stack.cache() = std::move(stack.cache());
+
+    read_end_of_problem(tail_stack, p);
+
+    return p;
 }
 
 bool
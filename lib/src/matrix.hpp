@@ -28,6 +28,7 @@
 #include <stdexcept>
 #include <vector>
 
+#include "bfloat16.hpp"
 #include "fixed_array.hpp"
 #include "utils.hpp"
 
@@ -52,14 +53,17 @@ operator<<(std::ostream& os, const SparseArray<A_T, P_T>& m);
  *     and accessors to the sparse array use @e std::vector<access>.
  *
  * @tparam A_T Type of element of matrix A.
- * @tparam P_T Type of element of matrix P.
+ * @tparam P_T Type of element of matrix P. A real or @c bfloat16 to reduce
+ *     the memory footprint of P.
  */
 template<typename A_T, typename P_T>
 class SparseArray
 {
 public:
     static_assert(std::is_integral<A_T>::value, "A_T Integer required.");
-    static_assert(std::is_floating_point<P_T>::value, "P_T Real required.");
+    static_assert(std::is_floating_point<P_T>::value or
+                    std::is_same<P_T, bfloat16>::value,
+                  "P_T Real required.");
 
     using a_type = A_T;
     using p_type = P_T;
@@ -137,6 +141,13 @@ public:
     void invert_p(index_type row, index_type col);
     void mult_p(index_type row, index_type col, p_type y);
 
+    /**
+     * @brief Updates P with the index @c id of the element in the A and P
+     *     vectors (@c access::value) instead of a search in the row.
+     */
+    void add_p(index_type id, p_type y) noexcept;
+    void invert_p(index_type id) noexcept;
+
     void mult_row_p(index_type row, p_type y);
 
     template<typename InputIterator>
@@ -148,9 +159,27 @@ public:
 
     void sort() noexcept;
 
+    /**
+     * @brief Builds the whole matrix from the constraints in linear time.
+     * @details Replaces the @c reserve(), @c set() and @c sort() sequence.
+     *     The columns are filled by counting sort on the rows order then the
+     *     rows are filled by walking the columns, so rows and columns are
+     *     sorted without any comparison. @c csts must provide, for each row,
+     *     an @c elements container of @c factor and @c variable_index. The
+     *     elements of A and P keep the constraints order and P is zeroed.
+     */
+    template<typename ConstraintsT>
+    void build(const ConstraintsT& csts);
+
     a_type A(index_type row, index_type col) const;
     p_type P(index_type row, index_type col) const;
 
+    /**
+     * @brief Returns the index of the element (@c row, @c col) in the A and
+     *     P vectors.
+     */
+    index_type find(index_type row, index_type col) const;
+
     std::vector<a_type>& A();
     const std::vector<a_type>& A() const;
     std::vector<p_type>& P();
@@ -360,6 +389,20 @@ SparseArray<A_T, P_T>::invert_p(index_type row, index_type col)
     m_p[it] = -m_p[it];
 }
 
+template<typename A_T, typename P_T>
+void
+SparseArray<A_T, P_T>::add_p(index_type id, p_type y) noexcept
+{
+    m_p[id] += y;
+}
+
+template<typename A_T, typename P_T>
+void
+SparseArray<A_T, P_T>::invert_p(index_type id) noexcept
+{
+    m_p[id] = -m_p[id];
+}
+
 template<typename A_T, typename P_T>
 void
 SparseArray<A_T, P_T>::mult_p(index_type row, index_type col, p_type y)
@@ -436,6 +479,67 @@ SparseArray<A_T, P_T>::sort() noexcept
     }
 }
 
+template<typename A_T, typename P_T>
+template<typename ConstraintsT>
+void
+SparseArray<A_T, P_T>::build(const ConstraintsT& csts)
+{
+    const auto rows = static_cast<index>(m_rows_access.size());
+    const auto cols = static_cast<index>(m_cols_access.size());
+
+    assert(rows == static_cast<index>(csts.size()) &&
+           "SparseArray: bad number of constraints");
+
+    // Counts the elements in each row and column and computes the offset of
+    // each row and column in the @c m_rows and @c m_cols arrays.
+
+    fixed_array<index> rcursor(rows), ccursor(cols, 0);
+    index elem{ 0 };
+
+    for (index i{ 0 }; i != rows; ++i) {
+        m_rows_access[i] = elem;
+        rcursor[i] = elem;
+
+        for (const auto& cst : csts[i].elements) {
+            ++ccursor[cst.variable_index];
+            ++elem;
+        }
+    }
+
+    for (index i{ 0 }, current{ 0 }; i != cols; ++i) {
+        m_cols_access[i] = current;
+        current += ccursor[i];
+        ccursor[i] = m_cols_access[i];
+    }
+
+    m_a.clear();
+    m_a.reserve(elem);
+    m_p.assign(elem, p_type{ 0 });
+
+    fixed_array<access>(elem).swap(m_rows);
+    fixed_array<access>(elem).swap(m_cols);
+
+    // Rows are read in increasing order, each column is then sorted by row.
+
+    for (index i{ 0 }, id{ 0 }; i != rows; ++i) {
+        for (const auto& cst : csts[i].elements) {
+            m_a.emplace_back(cst.factor);
+            m_cols[ccursor[cst.variable_index]++] = access(i, id++);
+        }
+    }
+
+    // Columns are read in increasing order, each row is then sorted by
+    // column.
+
+    for (index j{ 0 }; j != cols; ++j) {
+        const index end = (j + 1 < cols) ? m_cols_access[j + 1] : elem;
+
+        for (index k{ m_cols_access[j] }; k != end; ++k)
+            m_rows[rcursor[m_cols[k].position]++] =
+              access(j, m_cols[k].value);
+    }
+}
+
 template<typename A_T, typename P_T>
 typename SparseArray<A_T, P_T>::a_type
 SparseArray<A_T, P_T>::A(index_type row, index_type col) const
@@ -458,6 +562,15 @@ SparseArray<A_T, P_T>::P(index_type row, index_type col) const
     return m_p[it];
 }
 
+template<typename A_T, typename P_T>
+typename SparseArray<A_T, P_T>::index_type
+SparseArray<A_T, P_T>::find(index_type row, index_type col) const
+{
+    m_check_index(row, col);
+
+    return binary_find(row, col);
+}
+
 template<typename A_T, typename P_T>
 typename std::vector<typename SparseArray<A_T, P_T>::a_type>&
 SparseArray<A_T, P_T>::A()
@@ -529,6 +642,116 @@ SparseArray<A_T, P_T>::binary_find(
     return ret->value;
 }
 
+/**
+ * @brief A @c SparseArray structure shared between threads with a private
+ *     P matrix.
+ *
+ * @details The rows and columns accessors and the A values are read from a
+ *     @c SparseArray which must outlive this object and must not be
+ *     modified. Only the P values are owned by the @c SharedSparseArray, in
+ *     the same order as the A values. This lets the solvers of an
+ *     optimization build the structure of the problem once.
+ */
+template<typename A_T, typename P_T>
+class SharedSparseArray
+{
+public:
+    using sparse_array_type = SparseArray<A_T, P_T>;
+    using a_type = typename sparse_array_type::a_type;
+    using p_type = typename sparse_array_type::p_type;
+    using index_type = typename sparse_array_type::index_type;
+    using const_iterator = typename sparse_array_type::const_iterator;
+    using size_type = typename sparse_array_type::size_type;
+
+    explicit SharedSparseArray(const sparse_array_type& structure)
+      : m_structure(structure)
+      , m_p(structure.size(), static_cast<p_type>(0.0f))
+    {}
+
+    bool empty() const noexcept
+    {
+        return m_structure.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return m_structure.size();
+    }
+
+    std::tuple<const_iterator, const_iterator> row(index_type row) const
+      noexcept
+    {
+        return m_structure.row(row);
+    }
+
+    std::tuple<const_iterator, const_iterator> column(index_type col) const
+      noexcept
+    {
+        return m_structure.column(col);
+    }
+
+    void set_p(index_type row, index_type col, p_type y)
+    {
+        m_p[m_structure.find(row, col)] = y;
+    }
+
+    void add_p(index_type row, index_type col, p_type y)
+    {
+        m_p[m_structure.find(row, col)] += y;
+    }
+
+    void invert_p(index_type row, index_type col)
+    {
+        auto it = m_structure.find(row, col);
+
+        m_p[it] = -m_p[it];
+    }
+
+    void mult_p(index_type row, index_type col, p_type y)
+    {
+        m_p[m_structure.find(row, col)] *= y;
+    }
+
+    void add_p(index_type id, p_type y) noexcept
+    {
+        m_p[id] += y;
+    }
+
+    void invert_p(index_type id) noexcept
+    {
+        m_p[id] = -m_p[id];
+    }
+
+    a_type A(index_type row, index_type col) const
+    {
+        return m_structure.A()[m_structure.find(row, col)];
+    }
+
+    p_type P(index_type row, index_type col) const
+    {
+        return m_p[m_structure.find(row, col)];
+    }
+
+    const std::vector<a_type>& A() const noexcept
+    {
+        return m_structure.A();
+    }
+
+    fixed_array<p_type>& P() noexcept
+    {
+        return m_p;
+    }
+
+    const fixed_array<p_type>& P() const noexcept
+    {
+        return m_p;
+    }
+
+private:
+    const sparse_array_type& m_structure;
+    fixed_array<p_type> m_p;
+};
+
 } // namespace baryonyx
 
 #endif
@@ -0,0 +1,770 @@
+/* Copyright (C) 2017 INRA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <baryonyx/core>
+
+#include "private.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace bx = baryonyx;
+
+namespace {
+
+//
+// Internal form of a constraint: greater constraints are stored as less
+// constraints with negated factors, elements are sorted by variable index
+// and only reference variables not yet fixed or substituted.
+//
+struct presolve_row
+{
+    std::vector<bx::function_element> elements;
+    std::string label;
+    int value;
+    int id;
+    bx::operator_type type;
+    bool negated;
+    bool removed;
+};
+
+struct presolve_counters
+{
+    int fixed = 0;
+    int substituted = 0;
+    int removed = 0;
+    int tightened = 0;
+    int probed = 0;
+};
+
+class presolver
+{
+public:
+    presolver(const std::shared_ptr<bx::context>& ctx_,
+              bx::problem& pb_,
+              baryonyx_private::postsolve_stack& stack_)
+      : ctx(ctx_)
+      , pb(pb_)
+      , stack(stack_)
+      , cols(pb_.vars.values.size())
+      , fixed(pb_.vars.values.size(), -1)
+      , substituted(pb_.vars.values.size(), -1)
+      , complement(pb_.vars.values.size(), 0)
+      , cost(pb_.vars.values.size(), 0.0)
+      , constant(pb_.objective.value)
+      , minimize(pb_.type == bx::objective_function_type::minimize)
+    {
+        rows.reserve(bx::size(pb));
+
+        add_rows(pb.equal_constraints, bx::operator_type::equal, false);
+        add_rows(pb.less_constraints, bx::operator_type::less, false);
+        add_rows(pb.greater_constraints, bx::operator_type::less, true);
+
+        for (const auto& elem : pb.objective.elements)
+            cost[elem.variable_index] += elem.factor;
+    }
+
+    bool run(int rounds, int probing)
+    {
+        for (int round = 0; round != rounds and not infeasible; ++round) {
+            const auto previous = changes();
+
+            for (int r = 0, e = bx::length(rows); r != e; ++r)
+                reduce_row(r);
+
+            merge_cliques();
+            fix_dominated_columns();
+
+            if (probing > 0 and not infeasible)
+                probe(probing);
+
+            debug(ctx,
+                  "    - round {}: {} fixed {} substituted {} removed\n",
+                  round,
+                  counters.fixed,
+                  counters.substituted,
+                  counters.removed);
+
+            if (previous == changes())
+                break;
+        }
+
+        return not infeasible;
+    }
+
+    void commit()
+    {
+        const auto n = bx::length(pb.vars.values);
+        std::vector<int> index(n, -1);
+
+        bx::variables vars;
+        for (int j = 0; j != n; ++j) {
+            if (fixed[j] >= 0) {
+                pb.affected_vars.push_back(pb.vars.names[j], fixed[j]);
+            } else if (substituted[j] < 0) {
+                index[j] = bx::length(vars.values);
+                vars.names.emplace_back(pb.vars.names[j]);
+                vars.values.emplace_back(pb.vars.values[j]);
+            }
+        }
+
+        pb.equal_constraints.clear();
+        pb.less_constraints.clear();
+        pb.greater_constraints.clear();
+
+        for (auto& row : rows) {
+            if (row.removed)
+                continue;
+
+            bx::constraint cst;
+            cst.label = std::move(row.label);
+            cst.id = row.id;
+            cst.value = row.negated ? -row.value : row.value;
+
+            for (const auto& elem : row.elements)
+                cst.elements.emplace_back(
+                  row.negated ? -elem.factor : elem.factor,
+                  index[elem.variable_index]);
+
+            if (row.type == bx::operator_type::equal)
+                pb.equal_constraints.emplace_back(std::move(cst));
+            else if (row.negated)
+                pb.greater_constraints.emplace_back(std::move(cst));
+            else
+                pb.less_constraints.emplace_back(std::move(cst));
+        }
+
+        pb.objective.elements.clear();
+        pb.objective.value = constant;
+
+        for (int j = 0; j != n; ++j)
+            if (index[j] >= 0 and cost[j] != 0.0)
+                pb.objective.elements.emplace_back(cost[j], index[j]);
+
+        pb.vars = std::move(vars);
+    }
+
+    presolve_counters counters;
+
+private:
+    const std::shared_ptr<bx::context>& ctx;
+    bx::problem& pb;
+    baryonyx_private::postsolve_stack& stack;
+
+    std::vector<presolve_row> rows;
+    std::vector<std::vector<int>> cols;
+    std::vector<int> fixed;
+    std::vector<int> substituted;
+    std::vector<char> complement;
+    std::vector<double> cost;
+    double constant;
+    bool minimize;
+    bool infeasible = false;
+
+    int changes() const noexcept
+    {
+        return counters.fixed + counters.substituted + counters.removed +
+               counters.tightened;
+    }
+
+    void add_rows(const std::vector<bx::constraint>& csts,
+                  bx::operator_type type,
+                  bool negated)
+    {
+        for (const auto& cst : csts) {
+            const auto r = bx::length(rows);
+
+            rows.push_back({ cst.elements,
+                             cst.label,
+                             negated ? -cst.value : cst.value,
+                             cst.id,
+                             type,
+                             negated,
+                             false });
+
+            auto& elements = rows.back().elements;
+            std::sort(elements.begin(),
+                      elements.end(),
+                      [](const auto& lhs, const auto& rhs) {
+                          return lhs.variable_index < rhs.variable_index;
+                      });
+
+            for (auto& elem : elements) {
+                if (negated)
+                    elem.factor = -elem.factor;
+
+                cols[elem.variable_index].emplace_back(r);
+            }
+        }
+    }
+
+    static std::vector<bx::function_element>::iterator find(
+      std::vector<bx::function_element>& elements,
+      int variable)
+    {
+        auto it = std::lower_bound(
+          elements.begin(),
+          elements.end(),
+          variable,
+          [](const auto& elem, int v) { return elem.variable_index < v; });
+
+        return (it != elements.end() and it->variable_index == variable)
+                 ? it
+                 : elements.end();
+    }
+
+    void remove_row(int r)
+    {
+        if (not rows[r].removed) {
+            debug(ctx, "      constraint {} removed\n", rows[r].label);
+            rows[r].removed = true;
+            ++counters.removed;
+        }
+    }
+
+    void fix(int j, int value)
+    {
+        if (fixed[j] >= 0) {
+            if (fixed[j] != value)
+                infeasible = true;
+            return;
+        }
+
+        debug(ctx, "      variable {} = {}\n", pb.vars.names[j], value);
+
+        fixed[j] = value;
+        constant += cost[j] * value;
+        cost[j] = 0.0;
+        ++counters.fixed;
+
+        for (auto r : cols[j]) {
+            auto& row = rows[r];
+            auto it = find(row.elements, j);
+
+            if (it != row.elements.end()) {
+                row.value -= it->factor * value;
+                row.elements.erase(it);
+            }
+        }
+    }
+
+    //
+    // Replaces the variable @c x by @c y (or @c 1 - y) in all constraints and
+    // in the objective function.
+    //
+    void substitute(int x, int y, bool complemented)
+    {
+        debug(ctx,
+              "      variable {} = {}{}\n",
+              pb.vars.names[x],
+              complemented ? "1 - " : "",
+              pb.vars.names[y]);
+
+        for (auto r : cols[x]) {
+            auto& row = rows[r];
+            auto it = find(row.elements, x);
+
+            if (it == row.elements.end())
+                continue;
+
+            auto factor = it->factor;
+            row.elements.erase(it);
+
+            if (complemented) {
+                row.value -= factor;
+                factor = -factor;
+            }
+
+            auto jt = find(row.elements, y);
+            if (jt != row.elements.end()) {
+                jt->factor += factor;
+                if (jt->factor == 0)
+                    row.elements.erase(jt);
+            } else {
+                row.elements.insert(
+                  std::lower_bound(row.elements.begin(),
+                                   row.elements.end(),
+                                   y,
+                                   [](const auto& elem, int v) {
+                                       return elem.variable_index < v;
+                                   }),
+                  bx::function_element(factor, y));
+                cols[y].emplace_back(r);
+            }
+        }
+
+        if (complemented) {
+            constant += cost[x];
+            cost[y] -= cost[x];
+        } else {
+            cost[y] += cost[x];
+        }
+
+        cost[x] = 0.0;
+        substituted[x] = y;
+        complement[x] = complemented;
+        ++counters.substituted;
+
+        stack.substitutions.push_back(
+          { pb.vars.names[x], pb.vars.names[y], complemented });
+    }
+
+    std::tuple<int, int> activity(const presolve_row& row) const noexcept
+    {
+        int min = 0, max = 0;
+
+        for (const auto& elem : row.elements)
+            if (elem.factor < 0)
+                min += elem.factor;
+            else
+                max += elem.factor;
+
+        return std::make_tuple(min, max);
+    }
+
+    //
+    // Bound propagation of a constraint: detects infeasible and redundant
+    // constraints, fixes forced variables, eliminates doubleton equalities
+    // and tightens the coefficients of less constraints.
+    //
+    void reduce_row(int r)
+    {
+        if (rows[r].removed or infeasible)
+            return;
+
+        int min, max;
+        std::tie(min, max) = activity(rows[r]);
+
+        const bool equal = rows[r].type == bx::operator_type::equal;
+        const int value = rows[r].value;
+
+        if (min > value or (equal and max < value)) {
+            infeasible = true;
+            warning(ctx, "    - constraint {} is infeasible\n", rows[r].label);
+            return;
+        }
+
+        if ((not equal and max <= value) or rows[r].elements.empty()) {
+            remove_row(r);
+            return;
+        }
+
+        for (const auto& elem : rows[r].elements) {
+            const auto f = elem.factor;
+
+            if (min + std::abs(f) > value)
+                forced.emplace_back(elem.variable_index, f > 0 ? 0 : 1);
+            else if (equal and max - std::abs(f) < value)
+                forced.emplace_back(elem.variable_index, f > 0 ? 1 : 0);
+        }
+
+        if (not forced.empty()) {
+            for (const auto& elem : forced)
+                fix(elem.first, elem.second);
+
+            forced.clear();
+            reduce_row(r);
+            return;
+        }
+
+        if (equal and rows[r].elements.size() == 2)
+            reduce_doubleton(r);
+        else if (not equal)
+            tighten(r, max);
+    }
+
+    void reduce_doubleton(int r)
+    {
+        const auto& a = rows[r].elements[0];
+        const auto& b = rows[r].elements[1];
+
+        // Propagation has already fixed the variables with a single feasible
+        // value, so the remaining solutions are (0, 0) and (1, 1) or (0, 1)
+        // and (1, 0).
+
+        bool feasible[2][2];
+        for (int i = 0; i != 2; ++i)
+            for (int j = 0; j != 2; ++j)
+                feasible[i][j] =
+                  a.factor * i + b.factor * j == rows[r].value;
+
+        bool same = feasible[0][0] and feasible[1][1] and
+                    not feasible[0][1] and not feasible[1][0];
+        bool opposite = feasible[0][1] and feasible[1][0] and
+                        not feasible[0][0] and not feasible[1][1];
+
+        if (not same and not opposite)
+            return;
+
+        auto x = a.variable_index;
+        auto y = b.variable_index;
+        if (cols[x].size() < cols[y].size())
+            std::swap(x, y);
+
+        remove_row(r);
+        substitute(y, x, opposite);
+    }
+
+    void tighten(int r, int max)
+    {
+        auto& row = rows[r];
+
+        for (auto it = row.elements.begin(); it != row.elements.end();) {
+            if (it->factor > 0) {
+                const auto d = row.value - (max - it->factor);
+
+                if (d > 0) {
+                    it->factor -= d;
+                    row.value -= d;
+                    max -= d;
+                    ++counters.tightened;
+                }
+            } else {
+                const auto d = row.value - it->factor - max;
+
+                if (d > 0) {
+                    it->factor += d;
+                    ++counters.tightened;
+                }
+            }
+
+            if (it->factor == 0)
+                it = row.elements.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    bool is_clique(const presolve_row& row) const noexcept
+    {
+        if (row.removed or row.value != 1 or row.elements.size() < 2)
+            return false;
+
+        for (const auto& elem : row.elements)
+            if (elem.factor != 1)
+                return false;
+
+        return true;
+    }
+
+    //
+    // Set packing (sum x <= 1) and set partitioning (sum x = 1) constraints
+    // included in another one are merged: a packing constraint is removed, a
+    // partitioning constraint fixes to zero the other variables of its super
+    // set.
+    //
+    void merge_cliques()
+    {
+        for (int r = 0, e = bx::length(rows); r != e and not infeasible; ++r) {
+            if (not is_clique(rows[r]))
+                continue;
+
+            int pivot = rows[r].elements.front().variable_index;
+            for (const auto& elem : rows[r].elements)
+                if (cols[elem.variable_index].size() < cols[pivot].size())
+                    pivot = elem.variable_index;
+
+            for (auto s : cols[pivot]) {
+                if (s == r or not is_clique(rows[s]) or
+                    rows[s].elements.size() < rows[r].elements.size())
+                    continue;
+
+                if (not std::includes(rows[s].elements.begin(),
+                                      rows[s].elements.end(),
+                                      rows[r].elements.begin(),
+                                      rows[r].elements.end(),
+                                      [](const auto& lhs, const auto& rhs) {
+                                          return lhs.variable_index <
+                                                 rhs.variable_index;
+                                      }))
+                    continue;
+
+                if (rows[r].type == bx::operator_type::less) {
+                    remove_row(r);
+                    break;
+                }
+
+                for (const auto& elem : rows[s].elements)
+                    if (find(rows[r].elements, elem.variable_index) ==
+                        rows[r].elements.end())
+                        forced.emplace_back(elem.variable_index, 0);
+
+                for (const auto& elem : forced)
+                    fix(elem.first, elem.second);
+
+                forced.clear();
+                remove_row(s);
+            }
+        }
+    }
+
+    //
+    // A variable is dominated by its bound when moving it in the direction of
+    // its cost never increases the activity of a constraint against its
+    // right hand side: it is fixed to this bound.
+    //
+    void fix_dominated_columns()
+    {
+        for (int j = 0, e = bx::length(cols); j != e and not infeasible; ++j) {
+            if (fixed[j] >= 0 or substituted[j] >= 0)
+                continue;
+
+            int down = 0, up = 0;
+            for (auto r : cols[j]) {
+                if (rows[r].removed)
+                    continue;
+
+                auto it = find(rows[r].elements, j);
+                if (it == rows[r].elements.end())
+                    continue;
+
+                if (rows[r].type == bx::operator_type::equal) {
+                    ++down;
+                    ++up;
+                } else if (it->factor > 0) {
+                    ++up;
+                } else {
+                    ++down;
+                }
+            }
+
+            const auto c = minimize ? cost[j] : -cost[j];
+
+            if (down == 0 and c >= 0.0)
+                fix(j, 0);
+            else if (up == 0 and c <= 0.0)
+                fix(j, 1);
+        }
+    }
+
+    //
+    // Tentatively assigns the variable @c j and propagates the constraints
+    // with @c probe_value. Returns false if a constraint becomes infeasible.
+    //
+    bool propagate(int j, int value, long& budget)
+    {
+        probe_value[j] = value;
+        probe_list.emplace_back(j);
+
+        for (std::size_t i = probe_list.size() - 1; i != probe_list.size();
+             ++i) {
+            for (auto r : cols[probe_list[i]]) {
+                const auto& row = rows[r];
+                if (row.removed)
+                    continue;
+
+                int min = 0, max = 0, rhs = row.value;
+                budget -= bx::length(row.elements);
+
+                for (const auto& elem : row.elements) {
+                    const auto v = probe_value[elem.variable_index];
+
+                    if (v >= 0)
+                        rhs -= elem.factor * v;
+                    else if (elem.factor < 0)
+                        min += elem.factor;
+                    else
+                        max += elem.factor;
+                }
+
+                const bool equal = row.type == bx::operator_type::equal;
+                if (min > rhs or (equal and max < rhs))
+                    return false;
+
+                for (const auto& elem : row.elements) {
+                    const auto k = elem.variable_index;
+                    if (probe_value[k] >= 0)
+                        continue;
+
+                    const auto f = elem.factor;
+                    int forced_value = -1;
+
+                    if (min + std::abs(f) > rhs)
+                        forced_value = f > 0 ? 0 : 1;
+                    else if (equal and max - std::abs(f) < rhs)
+                        forced_value = f > 0 ? 1 : 0;
+
+                    if (forced_value >= 0) {
+                        probe_value[k] = forced_value;
+                        probe_list.emplace_back(k);
+                    }
+                }
+
+                if (budget < 0)
+                    return true;
+            }
+        }
+
+        return true;
+    }
+
+    void clear_probe()
+    {
+        for (auto k : probe_list)
+            probe_value[k] = -1;
+
+        probe_list.clear();
+    }
+
+    //
+    // Probing on binary variables: fixes a variable when one of its values
+    // leads to an infeasible propagation and fixes variables implied by
+    // both values.
+    //
+    void probe(int limit)
+    {
+        const auto n = bx::length(cols);
+        probe_value.assign(n, -1);
+
+        std::vector<int> candidates;
+        for (int j = 0; j != n; ++j)
+            if (fixed[j] < 0 and substituted[j] < 0)
+                candidates.emplace_back(j);
+
+        std::sort(candidates.begin(),
+                  candidates.end(),
+                  [this](int lhs, int rhs) {
+                      return cols[lhs].size() > cols[rhs].size();
+                  });
+
+        if (bx::length(candidates) > limit)
+            candidates.resize(limit);
+
+        std::vector<std::pair<int, int>> implied;
+
+        for (auto j : candidates) {
+            if (infeasible)
+                return;
+
+            if (fixed[j] >= 0 or substituted[j] >= 0)
+                continue;
+
+            long budget = 100000;
+            ++counters.probed;
+
+            const bool down = propagate(j, 0, budget);
+            for (auto k : probe_list)
+                if (k != j)
+                    implied.emplace_back(k, probe_value[k]);
+            clear_probe();
+
+            const bool up = propagate(j, 1, budget);
+
+            if (not down and not up) {
+                infeasible = true;
+            } else if (not down) {
+                fix(j, 1);
+            } else if (not up) {
+                fix(j, 0);
+            } else if (budget >= 0) {
+                for (const auto& elem : implied)
+                    if (probe_value[elem.first] == elem.second)
+                        forced.emplace_back(elem);
+            }
+
+            clear_probe();
+            implied.clear();
+
+            for (const auto& elem : forced)
+                fix(elem.first, elem.second);
+
+            forced.clear();
+        }
+    }
+
+    std::vector<std::pair<int, int>> forced;
+    std::vector<int> probe_value;
+    std::vector<int> probe_list;
+};
+
+} // anonymous namespace
+
+namespace baryonyx_private {
+
+postsolve_stack
+presolve(const std::shared_ptr<bx::context>& ctx, bx::problem& pb)
+{
+    postsolve_stack stack;
+
+    auto type = ctx->get_string_parameter("presolve", "none");
+    if (type == "none")
+        return stack;
+
+    const int probing =
+      type == "probing"
+        ? ctx->get_integer_parameter("presolve-probing-limit", 1000)
+        : 0;
+
+    info(ctx, "  - presolve ({}):\n", type);
+
+    presolver p(ctx, pb, stack);
+
+    if (not p.run(8, probing)) {
+        warning(ctx, "    `-> problem infeasible, presolve discarded\n");
+        return postsolve_stack();
+    }
+
+    p.commit();
+
+    info(ctx,
+         "    `-> {} variable(s) fixed - {} substituted - {} constraint(s) "
+         "removed - {} coefficient(s) tightened - {} probed\n",
+         p.counters.fixed,
+         p.counters.substituted,
+         p.counters.removed,
+         p.counters.tightened,
+         p.counters.probed);
+
+    return stack;
+}
+
+bx::result
+postsolve(const postsolve_stack& stack, bx::result r)
+{
+    if (stack.substitutions.empty() or
+        r.variable_value.size() != r.variable_name.size())
+        return r;
+
+    std::unordered_map<std::string, int> values;
+
+    for (std::size_t i = 0, e = r.variable_name.size(); i != e; ++i)
+        values.emplace(r.variable_name[i], r.variable_value[i]);
+
+    for (std::size_t i = 0, e = r.affected_vars.names.size(); i != e; ++i)
+        values.emplace(r.affected_vars.names[i], r.affected_vars.values[i]);
+
+    for (auto it = stack.substitutions.rbegin(),
+              et = stack.substitutions.rend();
+         it != et;
+         ++it) {
+        const auto target = values[it->target];
+        const auto value = it->complement ? 1 - target : target;
+
+        values[it->name] = value;
+        r.affected_vars.push_back(it->name, value);
+    }
+
+    return r;
+}
+
+} // namespace baryonyx_private
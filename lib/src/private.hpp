@@ -40,9 +40,39 @@ namespace baryonyx_private {
 baryonyx::problem
 read_problem(std::istream& is);
 
+baryonyx::problem
+read_problem(std::istream& is, int thread);
+
 baryonyx::result
 read_result(std::istream& is);
 
+using assignment_function =
+  std::function<void(const char* name, std::size_t size, int value)>;
+
+void
+read_result_assignments(const char* data,
+                        std::size_t size,
+                        const assignment_function& f);
+
+baryonyx::solution_report
+check_solution(const std::shared_ptr<baryonyx::context>& ctx,
+               const baryonyx::problem& pb,
+               const std::string& filename);
+
+void
+write_result(std::ostream& os,
+             const baryonyx::result& r,
+             const std::vector<std::string>& names,
+             const baryonyx::affected_variables& affected,
+             baryonyx::result_format format,
+             bool sparse);
+
+baryonyx::result_format
+get_result_format(const std::shared_ptr<baryonyx::context>& ctx);
+
+bool
+get_result_sparse(const std::shared_ptr<baryonyx::context>& ctx);
+
 bool
 write_problem(std::ostream& os, const baryonyx::problem& pb);
 
@@ -53,6 +83,77 @@ void
 preprocess(const std::shared_ptr<baryonyx::context>& ctx,
            baryonyx::problem& pb);
 
+/**
+ * @brief Stores the reductions of the presolve not recorded into the
+ *     affected variables of the problem.
+ *
+ * @details A substitution replaces the variable @c name by @c target (or
+ *     @c 1 - target if @c complement is true). Substitutions are undone in
+ *     reverse order by @c postsolve.
+ */
+struct postsolve_stack
+{
+    struct substitution
+    {
+        std::string name;
+        std::string target;
+        bool complement;
+    };
+
+    std::vector<substitution> substitutions;
+};
+
+postsolve_stack
+presolve(const std::shared_ptr<baryonyx::context>& ctx,
+         baryonyx::problem& pb);
+
+baryonyx::result
+postsolve(const postsolve_stack& stack, baryonyx::result r);
+
+/**
+ * @brief Moves the lower bounds of the general integer variables into the
+ *     constraints and the objective function.
+ *
+ * @details After the shift, the variable @c i takes a value in
+ *     @c [0, max - min]. The returned vector stores the lower bound of each
+ *     variable, 0 for binary variables. Throws @c solver_failure if a
+ *     variable is real, unbounded or has more than @c integer-domain-limit
+ *     values.
+ */
+std::vector<int>
+shift_integer_variables(const std::shared_ptr<baryonyx::context>& ctx,
+                        baryonyx::problem& pb);
+
+/**
+ * @brief Adds the lower bounds of @c shift_integer_variables to the values
+ *     of the result.
+ */
+baryonyx::result
+restore_integer_variables(const std::vector<int>& lower, baryonyx::result r);
+
+/**
+ * @brief Stores the independent sub-problems of a problem.
+ *
+ * @details Two variables belong to the same component if a constraint links
+ *     them. The variable @c j of the component @c c is the variable
+ *     @c variables[c][j] of the decomposed problem. @c components is empty
+ *     if the problem is not decomposed.
+ */
+struct decomposition
+{
+    std::vector<baryonyx::problem> components;
+    std::vector<std::vector<int>> variables;
+    std::vector<std::string> names;
+    baryonyx::affected_variables affected_vars;
+};
+
+decomposition
+decompose(const std::shared_ptr<baryonyx::context>& ctx,
+          baryonyx::problem& pb);
+
+baryonyx::result
+merge(decomposition& dec, std::vector<baryonyx::result>& results);
+
 baryonyx::result
 solve(const std::shared_ptr<baryonyx::context>& ctx, baryonyx::problem& pb);
 
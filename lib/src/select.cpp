@@ -24,6 +24,7 @@
 #include <baryonyx/core>
 
 #include <fstream>
+#include <future>
 #include <iterator>
 #include <thread>
 
@@ -40,7 +41,7 @@ namespace bx = baryonyx;
 //
 
 static inline int
-get_thread_number(std::shared_ptr<bx::context>& ctx) noexcept
+get_thread_number(const std::shared_ptr<bx::context>& ctx) noexcept
 {
     auto t = ctx->get_integer_parameter("thread",
                                         std::thread::hardware_concurrency());
@@ -102,22 +103,115 @@ is_101_coefficient(const bx::problem& pb) noexcept
            is_101_coefficient(pb.greater_constraints);
 }
 
+template<typename variableT>
+static bool
+has_general_variable(const variableT& vars) noexcept
+{
+    bool general = false;
+
+    for (const auto& elem : vars) {
+        if (elem.type == bx::variable_type::real)
+            return false;
+
+        if (elem.type == bx::variable_type::general)
+            general = true;
+    }
+
+    return general;
+}
+
+//
+// Solve the independent components of the problem in parallel when the
+// decomposition parameter is set, otherwise solve the whole problem. Each
+// component uses its own solver, so the time-limit applies to each
+// component from the start of its solver and the components do not race.
+// The components report their progress through one merger, the callback
+// receives the solution of the whole problem.
+//
+
+static bx::result
+solve_components(const std::shared_ptr<bx::context>& ctx,
+                 bx::problem& pb,
+                 int thread)
+{
+    auto dec = baryonyx_private::decompose(ctx, pb);
+    if (dec.components.empty())
+        return bx::itm::inequalities_Zcoeff_wedelin_solve(ctx, pb, thread);
+
+    const auto size = bx::numeric_cast<int>(dec.components.size());
+    const auto workers = std::min(get_thread_number(ctx), size);
+
+    std::vector<int> constraints(dec.components.size());
+    for (int c = 0; c != size; ++c)
+        constraints[c] = bx::numeric_cast<int>(bx::size(dec.components[c]));
+
+    bx::itm::progress_merger merger(
+      dec.variables, std::move(constraints), dec.names.size());
+
+    std::vector<bx::result> results(dec.components.size());
+    std::vector<std::thread> pool;
+    std::vector<std::future<void>> done;
+
+    for (int w = 0; w != workers; ++w) {
+        std::packaged_task<void()> task(
+          [&ctx, &dec, &merger, &results, w, workers]() {
+              for (auto c = w, e = bx::numeric_cast<int>(results.size());
+                   c < e;
+                   c += workers) {
+                  const bx::itm::progress_component component{ &merger, c };
+
+                  results[c] = bx::itm::inequalities_Zcoeff_wedelin_solve(
+                    ctx, dec.components[c], 1, &component);
+              }
+          });
+
+        done.emplace_back(task.get_future());
+        pool.emplace_back(std::move(task));
+    }
+
+    for (auto& t : pool)
+        t.join();
+
+    for (auto& f : done)
+        f.get();
+
+    return baryonyx_private::merge(dec, results);
+}
+
 namespace baryonyx_private {
 
 bx::result
 solve(const std::shared_ptr<bx::context>& ctx, bx::problem& pb)
 {
+    // With the race parameter, the solver runs on all the threads and
+    // returns the first feasible solution.
+
+    auto th =
+      ctx->get_integer_parameter("race", 0) != 0 ? get_thread_number(ctx) : 1;
+
+    // The binary preprocessing and presolve assume 0-1 domains, the general
+    // integer variables go to the integer solver without them.
+
+    if (has_general_variable(pb.vars.values)) {
+        auto lower = shift_integer_variables(ctx, pb);
+
+        return restore_integer_variables(
+          lower, bx::itm::inequalities_Zcoeff_integer_solve(ctx, pb, th));
+    }
+
     baryonyx_private::preprocess(ctx, pb);
 
     if (is_boolean_variable(pb.vars.values)) {
+        auto stack = baryonyx_private::presolve(ctx, pb);
+
         if (pb.greater_constraints.empty() and pb.less_constraints.empty() and
             is_boolean_coefficient(pb.equal_constraints))
-            return bx::itm::inequalities_Zcoeff_wedelin_solve(ctx, pb);
+            return postsolve(stack, solve_components(ctx, pb, th));
 
         if (is_101_coefficient(pb))
-            return bx::itm::inequalities_Zcoeff_wedelin_solve(ctx, pb);
+            return postsolve(stack, solve_components(ctx, pb, th));
 
-        return bx::itm::inequalities_Zcoeff_wedelin_solve(ctx, pb);
+        return postsolve(stack, solve_components(ctx, pb, th));
     }
 
     error(ctx, "no solver available for integer variable");
@@ -129,17 +223,36 @@ bx::result
 optimize(std::shared_ptr<bx::context> ctx, bx::problem& pb)
 {
     auto th = get_thread_number(ctx);
+
+    // As for the solver, the general integer variables skip the binary
+    // preprocessing and presolve. The integer optimizer neither writes
+    // checkpoints nor runs the local search.
+
+    if (has_general_variable(pb.vars.values)) {
+        auto lower = shift_integer_variables(ctx, pb);
+
+        return restore_integer_variables(
+          lower, bx::itm::inequalities_Zcoeff_integer_optimize(ctx, pb, th));
+    }
+
     baryonyx_private::preprocess(ctx, pb);
 
     if (is_boolean_variable(pb.vars.values)) {
+        auto stack = baryonyx_private::presolve(ctx, pb);
+
         if (pb.greater_constraints.empty() and pb.less_constraints.empty() and
             is_boolean_coefficient(pb.equal_constraints))
-            return bx::itm::inequalities_Zcoeff_wedelin_optimize(ctx, pb, th);
+            return postsolve(
+              stack,
+              bx::itm::inequalities_Zcoeff_wedelin_optimize(ctx, pb, th));
 
         if (is_101_coefficient(pb))
-            return bx::itm::inequalities_Zcoeff_wedelin_optimize(ctx, pb, th);
+            return postsolve(
+              stack,
+              bx::itm::inequalities_Zcoeff_wedelin_optimize(ctx, pb, th));
 
-        return bx::itm::inequalities_Zcoeff_wedelin_optimize(ctx, pb, th);
+        return postsolve(
+          stack, bx::itm::inequalities_Zcoeff_wedelin_optimize(ctx, pb, th));
     }
 
     error(ctx, "no optimizer available for integer variable");
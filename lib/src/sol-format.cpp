@@ -22,18 +22,289 @@
 
 #include <baryonyx/core>
 
+#include "private.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <cstring>
 #include <istream>
+#include <ostream>
 #include <string>
 
 #include <cctype>
+#include <climits>
 
-namespace baryonyx_private {
+namespace bx = baryonyx;
 
-baryonyx::result
-read_result(std::istream& is)
+static const char binary_magic[8] = {
+    'B', 'X', 'S', 'O', 'L', '0', '1', '\n'
+};
+
+//
+// Accumulates the output into a memory buffer flushed to the stream by
+// blocks to avoid the per variable cost of std::ostream formatting.
+//
+class result_buffer
+{
+public:
+    explicit result_buffer(std::ostream& os)
+      : m_os(os)
+    {
+        m_buffer.reserve(buffer_size + 4096);
+    }
+
+    ~result_buffer()
+    {
+        flush();
+    }
+
+    void append(const std::string& str)
+    {
+        m_buffer.append(str);
+        flush_if_full();
+    }
+
+    void append(const char* data, std::size_t size)
+    {
+        m_buffer.append(data, size);
+        flush_if_full();
+    }
+
+    void assignment(const std::string& name, int value)
+    {
+        char tmp[16];
+        char* end = tmp + sizeof(tmp);
+        char* ptr = end;
+
+        unsigned int v = value < 0 ? 0u - static_cast<unsigned int>(value)
+                                   : static_cast<unsigned int>(value);
+
+        do {
+            *--ptr = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v);
+
+        if (value < 0)
+            *--ptr = '-';
+
+        m_buffer.append(name);
+        m_buffer.push_back('=');
+        m_buffer.append(ptr, end - ptr);
+        m_buffer.push_back('\n');
+        flush_if_full();
+    }
+
+    template<typename T>
+    void binary(T value)
+    {
+        append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void binary(const std::string& str)
+    {
+        binary(static_cast<std::uint32_t>(str.size()));
+        append(str.data(), str.size());
+    }
+
+    void flush()
+    {
+        if (not m_buffer.empty()) {
+            m_os.write(m_buffer.data(),
+                       static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+        }
+    }
+
+private:
+    static constexpr std::size_t buffer_size = 1 << 20;
+
+    std::ostream& m_os;
+    std::string m_buffer;
+
+    void flush_if_full()
+    {
+        if (m_buffer.size() >= buffer_size)
+            flush();
+    }
+};
+
+static const char*
+status_string(bx::result_status status) noexcept
+{
+    switch (status) {
+    case bx::result_status::uninitialized:
+        return "uninitialized";
+    case bx::result_status::success:
+        return "solution found";
+    case bx::result_status::time_limit_reached:
+        return "time limit reached";
+    case bx::result_status::kappa_max_reached:
+        return "kappa max reached";
+    case bx::result_status::limit_reached:
+        return "limit reached";
+    }
+
+    return "uninitialized";
+}
+
+static void
+write_text_result(result_buffer& buf,
+                  const bx::result& r,
+                  const std::vector<std::string>& names,
+                  const bx::affected_variables& affected,
+                  bool sparse)
+{
+    buf.append(fmt::format("\\ solver................: {}\n"
+                           "\\ constraints...........: {}\n"
+                           "\\ variables.............: {}\n"
+                           "\\ duration..............: {}s\n"
+                           "\\ loop..................: {}\n"
+                           "\\ memory estimate.......: {} bytes\n"
+                           "\\ seed..................: {}\n"
+                           "\\ status................: {}\n",
+                           r.method,
+                           r.constraints,
+                           r.variables,
+                           r.duration,
+                           r.loop,
+                           r.memory_estimate,
+                           r.seed,
+                           status_string(r.status)));
+
+    if (r.status != bx::result_status::success) {
+        if (r.status != bx::result_status::uninitialized)
+            buf.append(fmt::format("\\ remaining constraints.: {}\n",
+                                   r.remaining_constraints));
+        return;
+    }
+
+    buf.append(fmt::format("\\ value.................: {}\n", r.value));
+
+    if (sparse)
+        buf.append(std::string("\\ format................: sparse\n"));
+
+    buf.append(std::string("\\ variables.............: \n"));
+
+    for (std::size_t i = 0, e = affected.names.size(); i != e; ++i)
+        if (not sparse or affected.values[i] != 0)
+            buf.assignment(affected.names[i], affected.values[i]);
+
+    for (std::size_t i = 0, e = names.size(); i != e; ++i)
+        if (not sparse or r.variable_value[i] != 0)
+            buf.assignment(names[i], r.variable_value[i]);
+}
+
+static void
+write_binary_result(result_buffer& buf,
+                    const bx::result& r,
+                    const std::vector<std::string>& names,
+                    const bx::affected_variables& affected,
+                    bool sparse)
+{
+    const bool success = r.status == bx::result_status::success;
+    std::uint32_t count = 0;
+
+    if (success) {
+        for (auto value : affected.values)
+            if (not sparse or value != 0)
+                ++count;
+
+        for (std::size_t i = 0, e = names.size(); i != e; ++i)
+            if (not sparse or r.variable_value[i] != 0)
+                ++count;
+    }
+
+    buf.append(binary_magic, sizeof(binary_magic));
+    buf.binary(r.method);
+    buf.binary(static_cast<std::int32_t>(r.status));
+    buf.binary(static_cast<std::int32_t>(sparse));
+    buf.binary(r.value);
+    buf.binary(r.duration);
+    buf.binary(static_cast<std::int32_t>(r.loop));
+    buf.binary(static_cast<std::int32_t>(r.variables));
+    buf.binary(static_cast<std::int32_t>(r.constraints));
+    buf.binary(static_cast<std::int32_t>(r.remaining_constraints));
+    buf.binary(count);
+
+    if (not success)
+        return;
+
+    for (std::size_t i = 0, e = affected.names.size(); i != e; ++i) {
+        if (not sparse or affected.values[i] != 0) {
+            buf.binary(affected.names[i]);
+            buf.binary(static_cast<std::int32_t>(affected.values[i]));
+        }
+    }
+
+    for (std::size_t i = 0, e = names.size(); i != e; ++i) {
+        if (not sparse or r.variable_value[i] != 0) {
+            buf.binary(names[i]);
+            buf.binary(static_cast<std::int32_t>(r.variable_value[i]));
+        }
+    }
+}
+
+template<typename T>
+static T
+read_binary(std::istream& is)
+{
+    T value;
+
+    if (not is.read(reinterpret_cast<char*>(&value), sizeof(T)))
+        throw bx::file_format_failure(bx::file_format_error_tag::end_of_file,
+                                      0,
+                                      static_cast<int>(is.gcount()));
+
+    return value;
+}
+
+static std::string
+read_binary_string(std::istream& is)
+{
+    auto size = read_binary<std::uint32_t>(is);
+    std::string ret(size, '\0');
+
+    if (size > 0 and not is.read(&ret[0], size))
+        throw bx::file_format_failure(
+          bx::file_format_error_tag::end_of_file, 0, 0);
+
+    return ret;
+}
+
+static bx::result
+read_binary_result(std::istream& is)
 {
-    baryonyx::result ret;
-    ret.status = baryonyx::result_status::success;
+    bx::result ret;
+
+    ret.method = read_binary_string(is);
+    ret.status =
+      static_cast<bx::result_status>(read_binary<std::int32_t>(is));
+    ret.sparse = read_binary<std::int32_t>(is) != 0;
+    ret.value = read_binary<double>(is);
+    ret.duration = read_binary<double>(is);
+    ret.loop = read_binary<std::int32_t>(is);
+    ret.variables = read_binary<std::int32_t>(is);
+    ret.constraints = read_binary<std::int32_t>(is);
+    ret.remaining_constraints = read_binary<std::int32_t>(is);
+
+    auto count = read_binary<std::uint32_t>(is);
+    ret.variable_name.reserve(count);
+    ret.variable_value.reserve(count);
+
+    for (std::uint32_t i = 0; i != count; ++i) {
+        ret.variable_name.emplace_back(read_binary_string(is));
+        ret.variable_value.emplace_back(read_binary<std::int32_t>(is));
+    }
+
+    return ret;
+}
+
+static bx::result
+read_text_result(std::istream& is)
+{
+    bx::result ret;
+    ret.status = bx::result_status::success;
     int line{ 0 };
 
     std::string buffer;
@@ -50,8 +321,13 @@ read_result(std::istream& is)
             if (not std::isspace(buffer[i]))
                 break;
 
-        if (i != e and buffer[i] == '\\')
+        if (i != e and buffer[i] == '\\') {
+            if (buffer.compare(i, 8, "\\ format") == 0 and
+                buffer.find(": sparse", i) != std::string::npos)
+                ret.sparse = true;
+
             continue;
+        }
 
         auto it = buffer.find('=', 0);
         if (it == std::string::npos)
@@ -75,4 +351,190 @@ read_result(std::istream& is)
 
     return ret;
 }
+
+//
+// Memory readers used by the solution checker: they call the functor for each
+// assignment without allocating the name.
+//
+
+template<typename T>
+static T
+read_binary(const char*& ptr, const char* end)
+{
+    if (static_cast<std::size_t>(end - ptr) < sizeof(T))
+        throw bx::file_format_failure(
+          bx::file_format_error_tag::end_of_file, 0, 0);
+
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    ptr += sizeof(T);
+
+    return value;
+}
+
+static void
+read_binary_assignments(const char* ptr,
+                        const char* end,
+                        const baryonyx_private::assignment_function& f)
+{
+    ptr += sizeof(binary_magic);
+
+    auto method = read_binary<std::uint32_t>(ptr, end);
+    if (static_cast<std::size_t>(end - ptr) < method)
+        throw bx::file_format_failure(
+          bx::file_format_error_tag::end_of_file, 0, 0);
+
+    ptr += method;
+    ptr += 2 * sizeof(std::int32_t) + 2 * sizeof(double) +
+           4 * sizeof(std::int32_t);
+
+    auto count = read_binary<std::uint32_t>(ptr, end);
+
+    for (std::uint32_t i = 0; i != count; ++i) {
+        auto size = read_binary<std::uint32_t>(ptr, end);
+        if (static_cast<std::size_t>(end - ptr) < size)
+            throw bx::file_format_failure(
+              bx::file_format_error_tag::end_of_file, 0, 0);
+
+        const char* name = ptr;
+        ptr += size;
+
+        f(name, size, read_binary<std::int32_t>(ptr, end));
+    }
 }
+
+static void
+read_text_assignments(const char* ptr,
+                      const char* end,
+                      const baryonyx_private::assignment_function& f)
+{
+    int line = 0;
+
+    while (ptr < end) {
+        const char* eol = static_cast<const char*>(
+          std::memchr(ptr, '\n', static_cast<std::size_t>(end - ptr)));
+        if (eol == nullptr)
+            eol = end;
+
+        const char* i = ptr;
+        while (i != eol and std::isspace(static_cast<unsigned char>(*i)))
+            ++i;
+
+        if (i != eol and *i != '\\') {
+            const char* equal = static_cast<const char*>(
+              std::memchr(i, '=', static_cast<std::size_t>(eol - i)));
+
+            if (equal == nullptr)
+                throw bx::file_format_failure(
+                  bx::file_format_error_tag::bad_name, line, 0);
+
+            const char* v = equal + 1;
+            while (v != eol and std::isspace(static_cast<unsigned char>(*v)))
+                ++v;
+
+            bool negative = false;
+            if (v != eol and (*v == '-' or *v == '+'))
+                negative = *v++ == '-';
+
+            if (v == eol or not std::isdigit(static_cast<unsigned char>(*v)))
+                throw bx::file_format_failure(
+                  bx::file_format_error_tag::bad_integer, line, 0);
+
+            long value = 0;
+            while (v != eol and std::isdigit(static_cast<unsigned char>(*v))) {
+                value = value * 10 + (*v - '0');
+                if (value > INT_MAX)
+                    throw bx::file_format_failure(
+                      bx::file_format_error_tag::bad_integer, line, 0);
+                ++v;
+            }
+
+            const char* last = equal;
+            while (last != i and
+                   std::isspace(static_cast<unsigned char>(*(last - 1))))
+                --last;
+
+            f(i,
+              static_cast<std::size_t>(last - i),
+              static_cast<int>(negative ? -value : value));
+        }
+
+        ptr = eol + 1;
+        ++line;
+    }
+}
+
+namespace baryonyx_private {
+
+void
+read_result_assignments(const char* data,
+                        std::size_t size,
+                        const assignment_function& f)
+{
+    if (size >= sizeof(binary_magic) and
+        std::memcmp(data, binary_magic, sizeof(binary_magic)) == 0)
+        read_binary_assignments(data, data + size, f);
+    else
+        read_text_assignments(data, data + size, f);
+}
+
+baryonyx::result
+read_result(std::istream& is)
+{
+    if (is.peek() != binary_magic[0])
+        return read_text_result(is);
+
+    char magic[sizeof(binary_magic)];
+    const auto position = is.tellg();
+
+    is.read(magic, sizeof(magic));
+    if (is.gcount() == sizeof(magic) and
+        std::memcmp(magic, binary_magic, sizeof(magic)) == 0)
+        return read_binary_result(is);
+
+    // A text solution starting with a `B' variable name: rewind the stream.
+
+    const auto read = is.gcount();
+    is.clear(is.rdstate() & ~(std::ios::failbit | std::ios::eofbit));
+
+    if (position != std::istream::pos_type(-1)) {
+        is.seekg(position);
+    } else {
+        for (auto i = read; i > 0; --i)
+            is.unget();
+    }
+
+    return read_text_result(is);
+}
+
+void
+write_result(std::ostream& os,
+             const baryonyx::result& r,
+             const std::vector<std::string>& names,
+             const baryonyx::affected_variables& affected,
+             baryonyx::result_format format,
+             bool sparse)
+{
+    result_buffer buf(os);
+
+    if (format == bx::result_format::binary)
+        write_binary_result(buf, r, names, affected, sparse);
+    else
+        write_text_result(buf, r, names, affected, sparse);
+}
+
+baryonyx::result_format
+get_result_format(const std::shared_ptr<baryonyx::context>& ctx)
+{
+    return ctx->get_string_parameter("sol-format", "text") == "binary"
+             ? bx::result_format::binary
+             : bx::result_format::text;
+}
+
+bool
+get_result_sparse(const std::shared_ptr<baryonyx::context>& ctx)
+{
+    return ctx->get_integer_parameter("sol-sparse", 0) != 0;
+}
+
+} // namespace baryonyx_private
@@ -28,6 +28,7 @@
 #include <fmt/format.h>
 #include <fmt/printf.h>
 
+#include <atomic>
 #include <chrono>
 
 #include <cassert>
@@ -48,7 +49,7 @@ is_loggable(context::message_type current_level,
 
 template<typename... Args>
 void
-log(std::shared_ptr<baryonyx::context> ctx,
+log(const std::shared_ptr<baryonyx::context>& ctx,
     context::message_type level,
     const char* fmt,
     const Args&... args)
@@ -56,7 +57,9 @@ log(std::shared_ptr<baryonyx::context> ctx,
     if (not is_loggable(ctx->log_priority(), level))
         return;
 
-    if (ctx->logger() == context::logger_type::c_file) {
+    if (ctx->async_logging()) {
+        ctx->push_log(level, fmt::format(fmt, args...));
+    } else if (ctx->logger() == context::logger_type::c_file) {
         fmt::print(ctx->cfile_logger(), fmt, args...);
     } else {
         ctx->string_logger()(level, fmt::format(fmt, args...));
@@ -65,14 +68,16 @@ log(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename... Args>
 void
-log(std::shared_ptr<baryonyx::context> ctx,
+log(const std::shared_ptr<baryonyx::context>& ctx,
     context::message_type level,
     const char* msg)
 {
     if (not is_loggable(ctx->log_priority(), level))
         return;
 
-    if (ctx->logger() == context::logger_type::c_file) {
+    if (ctx->async_logging()) {
+        ctx->push_log(level, fmt::format(msg));
+    } else if (ctx->logger() == context::logger_type::c_file) {
         fmt::print(ctx->cfile_logger(), msg);
     } else {
         ctx->string_logger()(level, fmt::format(msg));
@@ -89,7 +94,9 @@ log(baryonyx::context* ctx,
     if (not is_loggable(ctx->log_priority(), level))
         return;
 
-    if (ctx->logger() == context::logger_type::c_file) {
+    if (ctx->async_logging()) {
+        ctx->push_log(level, fmt::format(fmt, args...));
+    } else if (ctx->logger() == context::logger_type::c_file) {
         fmt::print(ctx->cfile_logger(), fmt, args...);
     } else {
         ctx->string_logger()(level, fmt::format(fmt, args...));
@@ -103,7 +110,9 @@ log(baryonyx::context* ctx, context::message_type level, const char* msg)
     if (not is_loggable(ctx->log_priority(), level))
         return;
 
-    if (ctx->logger() == context::logger_type::c_file) {
+    if (ctx->async_logging()) {
+        ctx->push_log(level, fmt::format(msg));
+    } else if (ctx->logger() == context::logger_type::c_file) {
         fmt::print(ctx->cfile_logger(), msg);
     } else {
         ctx->string_logger()(level, fmt::format(msg));
@@ -112,7 +121,7 @@ log(baryonyx::context* ctx, context::message_type level, const char* msg)
 
 template<typename... Args>
 void
-info(std::shared_ptr<baryonyx::context> ctx,
+info(const std::shared_ptr<baryonyx::context>& ctx,
      const char* fmt,
      const Args&... args)
 {
@@ -121,7 +130,7 @@ info(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename... Args>
 void
-debug(std::shared_ptr<baryonyx::context> ctx,
+debug(const std::shared_ptr<baryonyx::context>& ctx,
       const char* fmt,
       const Args&... args)
 {
@@ -130,7 +139,7 @@ debug(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename... Args>
 void
-warning(std::shared_ptr<baryonyx::context> ctx,
+warning(const std::shared_ptr<baryonyx::context>& ctx,
         const char* fmt,
         const Args&... args)
 {
@@ -139,7 +148,7 @@ warning(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename... Args>
 void
-error(std::shared_ptr<baryonyx::context> ctx,
+error(const std::shared_ptr<baryonyx::context>& ctx,
       const char* fmt,
       const Args&... args)
 {
@@ -148,7 +157,7 @@ error(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename Arg1, typename... Args>
 void
-info(std::shared_ptr<baryonyx::context> ctx,
+info(const std::shared_ptr<baryonyx::context>& ctx,
      const char* fmt,
      const Arg1& arg1,
      const Args&... args)
@@ -158,7 +167,7 @@ info(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename Arg1, typename... Args>
 void
-debug(std::shared_ptr<baryonyx::context> ctx,
+debug(const std::shared_ptr<baryonyx::context>& ctx,
       const char* fmt,
       const Arg1& arg1,
       const Args&... args)
@@ -180,7 +189,7 @@ debug(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename Arg1, typename... Args>
 void
-warning(std::shared_ptr<baryonyx::context> ctx,
+warning(const std::shared_ptr<baryonyx::context>& ctx,
         const char* fmt,
         const Arg1& arg1,
         const Args&... args)
@@ -190,7 +199,7 @@ warning(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename Arg1, typename... Args>
 void
-error(std::shared_ptr<baryonyx::context> ctx,
+error(const std::shared_ptr<baryonyx::context>& ctx,
       const char* fmt,
       const Arg1& arg1,
       const Args&... args)
@@ -200,14 +209,16 @@ error(std::shared_ptr<baryonyx::context> ctx,
 
 template<typename T>
 void
-log(std::shared_ptr<baryonyx::context> ctx,
+log(const std::shared_ptr<baryonyx::context>& ctx,
     context::message_type level,
     const T& msg)
 {
     if (not is_loggable(ctx->log_priority(), level))
         return;
 
-    if (ctx->logger() == context::logger_type::c_file) {
+    if (ctx->async_logging()) {
+        ctx->push_log(level, fmt::format("{}", msg));
+    } else if (ctx->logger() == context::logger_type::c_file) {
         fmt::print(ctx->cfile_logger(), "{}", msg);
     } else {
         ctx->string_logger()(level, fmt::format("{}", msg));
@@ -221,7 +232,9 @@ log(baryonyx::context* ctx, context::message_type level, const T& msg)
     if (not is_loggable(ctx->log_priority(), level))
         return;
 
-    if (ctx->logger() == context::logger_type::c_file) {
+    if (ctx->async_logging()) {
+        ctx->push_log(level, fmt::format("{}", msg));
+    } else if (ctx->logger() == context::logger_type::c_file) {
         fmt::print(ctx->cfile_logger(), "{}", msg);
     } else {
         ctx->string_logger()(level, fmt::format("{}", msg));
@@ -230,14 +243,14 @@ log(baryonyx::context* ctx, context::message_type level, const T& msg)
 
 template<typename T>
 void
-info(std::shared_ptr<baryonyx::context> ctx, const T& msg)
+info(const std::shared_ptr<baryonyx::context>& ctx, const T& msg)
 {
     log(ctx, context::message_type::info, msg);
 }
 
 template<typename T>
 void
-debug(std::shared_ptr<baryonyx::context> ctx, const T& msg)
+debug(const std::shared_ptr<baryonyx::context>& ctx, const T& msg)
 {
 #ifndef BARYONYX_DISABLE_LOGGING
     //
@@ -254,14 +267,14 @@ debug(std::shared_ptr<baryonyx::context> ctx, const T& msg)
 
 template<typename T>
 void
-warning(std::shared_ptr<baryonyx::context> ctx, const T& msg)
+warning(const std::shared_ptr<baryonyx::context>& ctx, const T& msg)
 {
     log(ctx, context::message_type::warning, msg);
 }
 
 template<typename T>
 void
-error(std::shared_ptr<baryonyx::context> ctx, const T& msg)
+error(const std::shared_ptr<baryonyx::context>& ctx, const T& msg)
 {
     log(ctx, context::message_type::err, msg);
 }
@@ -457,6 +470,82 @@ is_time_limit(double limit,
     return duration_cast<duration<double>>(end - begin).count() > limit;
 }
 
+/**
+ * @brief Polls the stop flag and the deadline of a @c context.
+ *
+ * @details The atomic stop flag is read at each call to @c poll() while the
+ *     steady clock is only read every @c period calls. The @c poll()
+ *     function is cheap enough to be called for each constraint. Once a stop
+ *     is detected, the poller remains stopped. An optional @c cancel flag,
+ *     read like the stop flag, stops the poller too: the first solver of a
+ *     race cancels the others.
+ *
+ * @code
+ * stop_poller stop(*ctx);
+ *
+ * for (int k = 0; k != m and not stop.poll(); ++k)
+ *     update_row(k);
+ * @endcode
+ */
+class stop_poller
+{
+public:
+    explicit stop_poller(const context& ctx, int period = 64) noexcept
+      : m_ctx(ctx)
+      , m_period(period <= 0 ? 1 : period)
+    {}
+
+    stop_poller(const context& ctx,
+                const std::atomic<bool>* cancel,
+                int period = 64) noexcept
+      : m_ctx(ctx)
+      , m_cancel(cancel)
+      , m_period(period <= 0 ? 1 : period)
+    {}
+
+    bool poll() noexcept
+    {
+        if (m_stopped)
+            return true;
+
+        if (m_ctx.stopped() or cancelled())
+            return m_stopped = true;
+
+        if (++m_count < m_period)
+            return false;
+
+        m_count = 0;
+
+        return m_stopped = std::chrono::steady_clock::now() >= m_ctx.deadline();
+    }
+
+    bool poll(std::chrono::steady_clock::time_point now) noexcept
+    {
+        if (m_stopped)
+            return true;
+
+        return m_stopped =
+                 m_ctx.stopped() or cancelled() or now >= m_ctx.deadline();
+    }
+
+    bool stopped() const noexcept
+    {
+        return m_stopped;
+    }
+
+private:
+    bool cancelled() const noexcept
+    {
+        return m_cancel and m_cancel->load(std::memory_order_relaxed);
+    }
+
+    const context& m_ctx;
+    const std::atomic<bool>* m_cancel = nullptr;
+    int m_period;
+    int m_count = 0;
+    bool m_stopped = false;
+};
+
 } // namespace baryonyx
 
 #endif
@@ -22,6 +22,7 @@
 
 #include "unit-test.hpp"
 
+#include <cstdio>
 #include <fstream>
 #include <map>
 #include <numeric>
@@ -225,6 +226,169 @@ test_verger_5_5(std::shared_ptr<baryonyx::context> ctx)
     fmt::print("{}\n{}\n", __func__, baryonyx::resume(pb));
 }
 
+void
+test_parallel_parser(std::shared_ptr<baryonyx::context> ctx)
+{
+    const char* files[] = { EXAMPLES_DIR "/8_queens_puzzle.lp",
+                            EXAMPLES_DIR "/capmo1_direct.lp",
+                            EXAMPLES_DIR "/general.lp",
+                            EXAMPLES_DIR "/negative-coeff.lp",
+                            EXAMPLES_DIR "/verger_5_5.lp" };
+
+    for (auto file : files) {
+        ctx->set_parameter("parse-thread", 1);
+        auto ref = baryonyx::make_problem(ctx, file);
+
+        for (int thread : { 2, 4, 16 }) {
+            ctx->set_parameter("parse-thread", thread);
+            auto pb = baryonyx::make_problem(ctx, file);
+
+            Ensures(pb == ref);
+            Ensures(pb.less_constraints.size() == ref.less_constraints.size());
+
+            for (std::size_t i = 0, e = pb.less_constraints.size(); i != e;
+                 ++i)
+                Ensures(pb.less_constraints[i].id ==
+                        ref.less_constraints[i].id);
+        }
+    }
+
+    const char* str_pb = "maximize\n"
+                         "obj: x1 + 2 x2 + 3 x3\n"
+                         "subject to\n"
+                         "c1: x1 + x2\n"
+                         "  + x3 <= 2\n"
+                         "c2: x1 - x3 >= -1 c3: x2\n"
+                         "\\ comment <= 1\n"
+                         "  + x4\n"
+                         "  = 1\n"
+                         "c4: x4 + x5 <=\n"
+                         "1\n"
+                         "binary\n"
+                         "x1 x2 x3 x4 x5\n"
+                         "end\n";
+
+    std::istringstream ref_is(str_pb);
+    ctx->set_parameter("parse-thread", 1);
+    auto ref = baryonyx::make_problem(ctx, ref_is);
+
+    for (int thread = 2; thread != 12; ++thread) {
+        std::istringstream is(str_pb);
+        ctx->set_parameter("parse-thread", thread);
+        auto pb = baryonyx::make_problem(ctx, is);
+
+        Ensures(pb == ref);
+        Ensures(pb.vars.names.size() == 5);
+    }
+
+    ctx->set_parameter("parse-thread", 1);
+}
+
+void
+test_result_formats(std::shared_ptr<baryonyx::context> ctx)
+{
+    baryonyx::result r;
+    r.method = "test";
+    r.status = baryonyx::result_status::success;
+    r.value = 12.5;
+    r.variables = 5;
+    r.affected_vars.push_back("x0", 1);
+    r.affected_vars.push_back("Bx1", 0);
+    r.variable_name = { "x2", "x3", "x4" };
+    r.variable_value = { 0, 1, 1 };
+
+    std::map<std::string, int> expected = {
+        { "x0", 1 }, { "Bx1", 0 }, { "x2", 0 }, { "x3", 1 }, { "x4", 1 }
+    };
+
+    for (auto format :
+         { baryonyx::result_format::text, baryonyx::result_format::binary }) {
+        for (bool sparse : { false, true }) {
+            std::stringstream ss;
+            baryonyx::write_result(ss, r, format, sparse);
+
+            auto re = baryonyx::make_result(ctx, ss);
+            Ensures(re.status == baryonyx::result_status::success);
+            Ensures(re.variable_name.size() == re.variable_value.size());
+            Ensures(re.variable_name.size() == (sparse ? 3 : 5));
+            Ensures(re.sparse == sparse);
+
+            for (std::size_t i = 0, e = re.variable_name.size(); i != e; ++i)
+                Ensures(expected[re.variable_name[i]] == re.variable_value[i]);
+
+            if (format == baryonyx::result_format::binary) {
+                Ensures(re.value == r.value);
+                Ensures(re.method == r.method);
+                Ensures(re.variables == r.variables);
+            }
+        }
+    }
+
+    {
+        std::stringstream ss;
+        ss << "Bx1=0\nx0=1\n";
+
+        auto re = baryonyx::make_result(ctx, ss);
+        Ensures(re.variable_name.size() == 2);
+        Ensures(re.variable_name[0] == "Bx1");
+    }
+
+    {
+        auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/general.lp");
+        baryonyx::result re;
+        re.status = baryonyx::result_status::success;
+        re.variable_name = { "x1", "x3" };
+        re.variable_value = { 1, 2 };
+
+        std::stringstream ss;
+        baryonyx::write_result(ss, re, baryonyx::result_format::text, true);
+        re = baryonyx::make_result(ctx, ss);
+
+        Ensures(baryonyx::is_valid_solution(pb, re));
+        Ensures(baryonyx::compute_solution(pb, re) == 1.0);
+    }
+}
+
+static void
+test_check_solution(std::shared_ptr<baryonyx::context> ctx)
+{
+    auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/general.lp");
+
+    baryonyx::result re;
+    re.status = baryonyx::result_status::success;
+    re.variable_name = { "x1", "x2", "x3" };
+    re.variable_value = { 1, 0, 2 };
+
+    for (auto format :
+         { baryonyx::result_format::text, baryonyx::result_format::binary }) {
+        for (bool sparse : { false, true }) {
+            {
+                std::ofstream ofs("check.sol", std::ios::binary);
+                baryonyx::write_result(ofs, re, format, sparse);
+            }
+
+            auto report = baryonyx::check_solution(ctx, pb, "check.sol");
+            Ensures(report.valid);
+            Ensures(report.violated_constraints.empty());
+            Ensures(report.unknown_variables == 0);
+            Ensures(report.value == 1.0);
+        }
+    }
+
+    {
+        std::ofstream ofs("check.sol", std::ios::binary);
+        ofs << "\\ invalid solution\nx1=0\nx3 = 2\ny=1\n";
+    }
+
+    auto report = baryonyx::check_solution(ctx, pb, "check.sol");
+    Ensures(not report.valid);
+    Ensures(report.violated_constraints.size() == 2);
+    Ensures(report.unknown_variables == 1);
+    Ensures(report.value == 2.0);
+
+    std::remove("check.sol");
+}
+
 int
 main(int /* argc */, char* /* argv */ [])
 {
@@ -238,6 +402,9 @@ main(int /* argc */, char* /* argv */ [])
     test_examples_8_queens_puzzle(ctx);
     test_examples_vm(ctx);
     test_verger_5_5(ctx);
+    test_parallel_parser(ctx);
+    test_result_formats(ctx);
+    test_check_solution(ctx);
 
     return unit_test::report_errors();
 }
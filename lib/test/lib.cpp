@@ -20,10 +20,13 @@
  * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include "bfloat16.hpp"
+#include "bit_array.hpp"
 #include "branch-and-bound-solver.hpp"
 #include "fixed_2darray.hpp"
 #include "fixed_array.hpp"
 #include "knapsack-dp-solver.hpp"
+#include "local-search.hpp"
 #include "matrix.hpp"
 #include "scoped_array.hpp"
 #include "unit-test.hpp"
@@ -35,6 +38,7 @@
 
 #include <functional>
 #include <numeric>
+#include <thread>
 
 #include <iostream>
 
@@ -228,6 +232,151 @@ check_matrix()
     Ensures(m.P()[3] == 4.0);
 }
 
+static void
+check_matrix_build()
+{
+    struct element
+    {
+        int factor;
+        int variable_index;
+    };
+
+    struct constraint
+    {
+        std::vector<element> elements;
+    };
+
+    std::vector<constraint> csts{ { { { 1, 0 }, { -2, 2 }, { 3, 3 } } },
+                                  { { { 4, 1 } } },
+                                  { { { -5, 0 }, { 6, 1 }, { 7, 3 } } },
+                                  { { { 8, 2 }, { 9, 3 } } } };
+
+    std::vector<int> row{ 3, 1, 3, 2 };
+    std::vector<int> col{ 2, 2, 2, 3 };
+
+    baryonyx::SparseArray<int, double> ref(4, 4), m(4, 4);
+    ref.reserve(9, row.begin(), row.end(), col.begin(), col.end());
+    for (int i{ 0 }; i != 4; ++i)
+        for (const auto& elem : csts[i].elements)
+            ref.set(i, elem.variable_index, elem.factor, 0.0);
+    ref.sort();
+
+    m.build(csts);
+
+    Ensures(m.size() == ref.size());
+    Ensures(m.A() == ref.A());
+    Ensures(m.P() == ref.P());
+
+    for (int i{ 0 }; i != 4; ++i) {
+        auto lhs = m.row(i);
+        auto rhs = ref.row(i);
+
+        Ensures(size(lhs) == size(rhs));
+        for (; std::get<0>(lhs) != std::get<1>(lhs);
+             ++std::get<0>(lhs), ++std::get<0>(rhs)) {
+            Ensures(std::get<0>(lhs)->position == std::get<0>(rhs)->position);
+            Ensures(std::get<0>(lhs)->value == std::get<0>(rhs)->value);
+        }
+
+        lhs = m.column(i);
+        rhs = ref.column(i);
+
+        Ensures(size(lhs) == size(rhs));
+        for (; std::get<0>(lhs) != std::get<1>(lhs);
+             ++std::get<0>(lhs), ++std::get<0>(rhs)) {
+            Ensures(std::get<0>(lhs)->position == std::get<0>(rhs)->position);
+            Ensures(std::get<0>(lhs)->value == std::get<0>(rhs)->value);
+        }
+    }
+
+    Ensures(m.A(2, 3) == 7);
+    Ensures(m.A(3, 2) == 8);
+}
+
+static void
+check_bfloat16()
+{
+    baryonyx::bfloat16 zero(0.0f);
+    Ensures(static_cast<float>(zero) == 0.0f);
+
+    baryonyx::bfloat16 one(1.0f);
+    Ensures(static_cast<float>(one) == 1.0f);
+    Ensures(static_cast<float>(-one) == -1.0f);
+
+    // 1 + 2^-8 is not representable and is rounded to the nearest even (1)
+    // while 1 + 3 * 2^-8 is rounded up to 1 + 2^-6.
+    Ensures(static_cast<float>(baryonyx::bfloat16(1.00390625f)) == 1.0f);
+    Ensures(static_cast<float>(baryonyx::bfloat16(1.01171875f)) ==
+            1.015625f);
+
+    baryonyx::bfloat16 x(0.5f);
+    x += 0.25f;
+    Ensures(static_cast<float>(x) == 0.75f);
+    x *= 2.0f;
+    Ensures(static_cast<float>(x) == 1.5f);
+    x -= 1.5f;
+    Ensures(static_cast<float>(x) == 0.0f);
+
+    std::vector<int> row{ 1, 1 };
+    std::vector<int> col{ 2 };
+
+    baryonyx::SparseArray<int, baryonyx::bfloat16> m(2, 1);
+    m.reserve(2, row.begin(), row.end(), col.begin(), col.end());
+    m.set(0, 0, 1, 0.0f);
+    m.set(1, 0, -1, 0.0f);
+    m.sort();
+
+    m.add_p(0, 0, 0.125f);
+    m.add_p(1, 0, 2.0f);
+    m.invert_p(1, 0);
+    m.mult_p(0, 0, 4.0f);
+
+    Ensures(static_cast<float>(m.P(0, 0)) == 0.5f);
+    Ensures(static_cast<float>(m.P(1, 0)) == -2.0f);
+}
+
+static void
+check_shared_matrix()
+{
+    std::vector<int> row{ 2, 1 };
+    std::vector<int> col{ 1, 1, 1 };
+
+    baryonyx::SparseArray<int, double> m(2, 3);
+    m.reserve(3, row.begin(), row.end(), col.begin(), col.end());
+    m.set(0, 2, 1, 0.0);
+    m.set(0, 0, -1, 0.0);
+    m.set(1, 1, 2, 0.0);
+    m.sort();
+
+    baryonyx::SharedSparseArray<int, double> first(m), second(m);
+
+    Ensures(first.size() == 3);
+    Ensures(first.A(0, 0) == -1);
+    Ensures(second.A(1, 1) == 2);
+    Ensures(&first.A() == &second.A());
+    Ensures(m.A()[m.find(0, 2)] == 1);
+
+    first.add_p(0, 2, 0.5);
+    first.invert_p(0, 2);
+    second.set_p(1, 1, 3.0);
+
+    Ensures(first.P(0, 2) == -0.5);
+    Ensures(first.P(1, 1) == 0.0);
+    Ensures(second.P(0, 2) == 0.0);
+    Ensures(second.P(1, 1) == 3.0);
+
+    second.add_p(m.find(0, 0), 2.0);
+    second.invert_p(m.find(1, 1));
+
+    Ensures(second.P(0, 0) == 2.0);
+    Ensures(second.P(1, 1) == -3.0);
+
+    m.add_p(m.find(0, 2), 1.5);
+    m.invert_p(m.find(0, 2));
+
+    Ensures(m.P(0, 2) == -1.5);
+}
+
 static void
 check_scoped_array()
 {
@@ -280,6 +429,51 @@ check_scoped_array()
     }
 }
 
+static void
+check_bit_array()
+{
+    baryonyx::bit_array a(130);
+
+    Ensures(a.size() == 130);
+    Ensures(baryonyx::bit_array::words(130) == 3);
+
+    for (int i = 0; i != 130; ++i)
+        Ensures(a[i] == 0);
+
+    a[0] = 1;
+    a(64) = 1;
+    a[129] = true;
+    a[3] = a[0];
+
+    Ensures(a[0] == 1);
+    Ensures(a[3] == 1);
+    Ensures(a(64) == 1);
+    Ensures(a[129] == 1);
+    Ensures(a[128] == 0);
+
+    a[0] = 1 - a[0];
+    Ensures(a[0] == 0);
+
+    Ensures(baryonyx::popcount(a.data()[0]) == 1);
+    Ensures(baryonyx::popcount(a.data()[1]) == 1);
+    Ensures(baryonyx::popcount(a.data()[2]) == 1);
+    Ensures(baryonyx::popcount(~std::uint64_t{ 0 }) == 64);
+
+    baryonyx::bit_array b(a);
+    b[3] = 0;
+
+    Ensures(a[3] == 1);
+    Ensures(b[3] == 0);
+    Ensures(b[129] == 1);
+
+    b = a;
+    Ensures(b[3] == 1);
+
+    const baryonyx::bit_array& c = b;
+    Ensures(c[64] == 1);
+    Ensures(c(65) == 0);
+}
+
 static void
 check_fixed_array()
 {
@@ -520,6 +714,122 @@ check_branch_and_bound_solver()
     }
 }
 
+static void
+check_local_search()
+{
+    // minimize: 3x0 + x1 + 2x2 - x3 - 2x4
+    // st: x0 + x1 + x2 = 1
+    //     x3 + x4 <= 1
+    //
+    // Starting from x = (1, 0, 0, 0, 0), a 1-flip sets x4 and a 2-swap
+    // moves x0 to x1.
+
+    struct bound
+    {
+        int min;
+        int max;
+    };
+
+    using local_search_type =
+      baryonyx::details::local_search<baryonyx::minimize_tag, double>;
+
+    std::vector<int> row{ 3, 2 };
+    std::vector<int> col{ 1, 1, 1, 1, 1 };
+
+    baryonyx::SparseArray<int, double> ap(2, 5);
+    ap.reserve(5, row.begin(), row.end(), col.begin(), col.end());
+    ap.set(0, 0, 1, 0.0);
+    ap.set(0, 1, 1, 0.0);
+    ap.set(0, 2, 1, 0.0);
+    ap.set(1, 3, 1, 0.0);
+    ap.set(1, 4, 1, 0.0);
+    ap.sort();
+
+    baryonyx::fixed_array<bound> b(2);
+    b(0) = { 1, 1 };
+    b(1) = { 0, 1 };
+
+    baryonyx::fixed_array<double> c(5);
+    c[0] = 3;
+    c[1] = 1;
+    c[2] = 2;
+    c[3] = -1;
+    c[4] = -2;
+
+    {
+        baryonyx::fixed_array<std::int8_t> x(5, 0);
+        x[0] = 1;
+
+        local_search_type ls(2, 5);
+
+        Ensures(ls.run(ap, b, x, c, 100, 0, false) == true);
+        Ensures(x[0] == 1 and x[1] == 0 and x[2] == 0);
+        Ensures(x[3] == 0 and x[4] == 1);
+    }
+
+    {
+        baryonyx::fixed_array<std::int8_t> x(5, 0);
+        x[0] = 1;
+
+        local_search_type ls(2, 5);
+
+        Ensures(ls.run(ap, b, x, c, 100, 2, true) == true);
+        Ensures(x[0] == 0 and x[1] == 1 and x[2] == 0);
+        Ensures(x[3] == 0 and x[4] == 1);
+    }
+}
+
+static void
+check_async_logger()
+{
+    std::vector<std::string> messages;
+
+    auto ctx = std::make_shared<baryonyx::context>(
+      [&messages](baryonyx::context::message_type, std::string msg) {
+          messages.emplace_back(std::move(msg));
+      });
+
+    ctx->set_async_logging(true);
+    Ensures(ctx->async_logging());
+
+    // More messages than the capacity of a ring buffer and two rounds of
+    // threads to reuse the rings of the first round.
+    for (int round = 0; round != 2; ++round) {
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i != 4; ++i)
+            threads.emplace_back([&ctx, i]() {
+                for (int j = 0; j != 3000; ++j)
+                    baryonyx::info(ctx, "{} {}\n", i, j);
+            });
+
+        for (auto& thread : threads)
+            thread.join();
+
+        ctx->flush_log();
+        Ensures(messages.size() == 12000u);
+
+        std::vector<int> next(4, 0);
+        bool ordered = true;
+
+        for (const auto& msg : messages) {
+            int i = 0, j = 0;
+            std::sscanf(msg.c_str(), "%d %d", &i, &j);
+            ordered = ordered and next[i] == j;
+            next[i] = j + 1;
+        }
+
+        Ensures(ordered);
+        messages.clear();
+    }
+
+    ctx->set_async_logging(false);
+    Ensures(not ctx->async_logging());
+
+    baryonyx::info(ctx, "sync\n");
+    Ensures(messages.size() == 1u);
+}
+
 int
 main(int /* argc */, char* /* argv */ [])
 {
@@ -527,11 +837,17 @@ main(int /* argc */, char* /* argv */ [])
     check_numeric_cast();
     check_parameter();
     check_matrix();
+    check_matrix_build();
+    check_shared_matrix();
+    check_bfloat16();
     check_scoped_array();
+    check_bit_array();
     check_fixed_array();
     check_fixed_2darray();
     check_knapsack_solver();
     check_branch_and_bound_solver();
+    check_local_search();
+    check_async_logger();
 
     return unit_test::report_errors();
 }
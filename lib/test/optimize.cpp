@@ -22,11 +22,14 @@
 
 #include "unit-test.hpp"
 
+#include <chrono>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <random>
 #include <sstream>
+#include <thread>
 
 #include <baryonyx/core-compare>
 #include <baryonyx/core-out>
@@ -35,6 +38,8 @@
 
 #include <fmt/printf.h>
 
+#include <cstdio>
+
 void
 test_qap(const std::shared_ptr<baryonyx::context>& ctx)
 {
@@ -70,6 +75,134 @@ test_qap(const std::shared_ptr<baryonyx::context>& ctx)
     }
 }
 
+void
+test_stop_and_deadline()
+{
+    using std::chrono::duration;
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    {
+        // Without time limit, only the deadline stops the optimizer.
+
+        auto ctx = std::make_shared<baryonyx::context>();
+        auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/small4.lp");
+
+        ctx->set_parameter("limit", -1);
+        ctx->set_parameter("time-limit", -1.0);
+        ctx->set_parameter("thread", 2);
+
+        auto begin = steady_clock::now();
+        ctx->set_deadline(begin + milliseconds(500));
+
+        auto result = baryonyx::optimize(ctx, pb);
+        auto d = duration_cast<duration<double>>(steady_clock::now() - begin);
+
+        Ensures(d.count() < 5.0);
+        if (result.status == baryonyx::result_status::success) {
+            auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/small4.lp");
+            Ensures(baryonyx::is_valid_solution(pb, result.variable_value) ==
+                    true);
+        }
+    }
+
+    {
+        // The stop flag is raised by another thread.
+
+        auto ctx = std::make_shared<baryonyx::context>();
+        auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/small4.lp");
+
+        ctx->set_parameter("limit", -1);
+        ctx->set_parameter("time-limit", -1.0);
+        ctx->set_parameter("thread", 2);
+
+        auto begin = steady_clock::now();
+        std::thread stopper([ctx]() {
+            std::this_thread::sleep_for(milliseconds(500));
+            ctx->stop();
+        });
+
+        auto result = baryonyx::optimize(ctx, pb);
+        auto d = duration_cast<duration<double>>(steady_clock::now() - begin);
+        stopper.join();
+
+        Ensures(ctx->stopped());
+        Ensures(d.count() < 5.0);
+        if (result.status == baryonyx::result_status::success) {
+            auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/small4.lp");
+            Ensures(baryonyx::is_valid_solution(pb, result.variable_value) ==
+                    true);
+        }
+
+        ctx->clear_stop();
+        Ensures(not ctx->stopped());
+    }
+}
+
+void
+test_portfolio()
+{
+    {
+        // Threads race the built-in configurations.
+
+        auto ctx = std::make_shared<baryonyx::context>();
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        ctx->set_parameter("limit", 50);
+        ctx->set_parameter("time-limit", 1.0);
+        ctx->set_parameter("thread", 4);
+        ctx->set_parameter("seed", 123654785);
+        ctx->set_parameter("portfolio", std::string("builtin"));
+
+        auto result = baryonyx::optimize(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        if (result.status == baryonyx::result_status::success) {
+            auto pb =
+              baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+            Ensures(baryonyx::is_valid_solution(pb, result.variable_value) ==
+                    true);
+        }
+    }
+
+    {
+        // Configurations read from a file, one per line.
+
+        {
+            std::ofstream ofs("portfolio.txt");
+            ofs << "# theta and constraint order\n"
+                << "theta=0.3 constraint-order=reversing\n"
+                << "\n"
+                << "theta:0.6 kappa-step=0.01 norm=l1 init-policy=random\n";
+        }
+
+        auto ctx = std::make_shared<baryonyx::context>();
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        ctx->set_parameter("limit", 50);
+        ctx->set_parameter("time-limit", 1.0);
+        ctx->set_parameter("thread", 2);
+        ctx->set_parameter("seed", 123654785);
+        ctx->set_parameter("portfolio", std::string("file"));
+        ctx->set_parameter("portfolio-file", std::string("portfolio.txt"));
+
+        auto result = baryonyx::optimize(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        if (result.status == baryonyx::result_status::success) {
+            auto pb =
+              baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+            Ensures(baryonyx::is_valid_solution(pb, result.variable_value) ==
+                    true);
+        }
+
+        std::remove("portfolio.txt");
+    }
+}
+
 void
 test_n_queens_problem(const std::shared_ptr<baryonyx::context>& ctx)
 {
@@ -151,11 +284,188 @@ test_n_queens_problem(const std::shared_ptr<baryonyx::context>& ctx)
     Ensures(all_found == valid_solutions.size());
 }
 
+void
+test_memory_limit()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    ctx->set_parameter("limit", 50);
+    ctx->set_parameter("time-limit", 1.0);
+    ctx->set_parameter("seed", 123654785);
+
+    ctx->set_parameter("thread", 1);
+    auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+    auto one = baryonyx::optimize(ctx, pb).memory_estimate;
+
+    ctx->set_parameter("thread", 4);
+    pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+    auto four = baryonyx::optimize(ctx, pb).memory_estimate;
+
+    Ensures(one > 0);
+    Ensures(four > one);
+
+    {
+        // Only two threads fit in the budget.
+
+        auto per_thread = (four - one) / 3;
+        ctx->set_parameter("memory-limit",
+                           (one + per_thread + per_thread / 2) /
+                             (1024.0 * 1024.0));
+
+        pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+        auto result = baryonyx::optimize(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        Ensures(result.memory_estimate == one + per_thread);
+    }
+
+    {
+        // Nothing fits: the optimizer must fail before allocating.
+
+        ctx->set_parameter("memory-limit", 1.e-6);
+        pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        bool failure = false;
+        try {
+            baryonyx::optimize(ctx, pb);
+        } catch (const baryonyx::solver_failure& e) {
+            failure =
+              e.failure() == baryonyx::solver_error_tag::not_enough_memory;
+        }
+
+        Ensures(failure);
+    }
+}
+
+void
+test_thread_affinity()
+{
+    for (auto policy : { "compact", "scatter" }) {
+        auto ctx = std::make_shared<baryonyx::context>();
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        ctx->set_parameter("limit", 50);
+        ctx->set_parameter("time-limit", 1.0);
+        ctx->set_parameter("thread", 3);
+        ctx->set_parameter("seed", 123654785);
+        ctx->set_parameter("thread-affinity", std::string(policy));
+        ctx->set_parameter("numa-replicate", 1);
+
+        auto result = baryonyx::optimize(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        if (result.status == baryonyx::result_status::success) {
+            auto pb =
+              baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+            Ensures(baryonyx::is_valid_solution(pb, result.variable_value) ==
+                    true);
+        }
+    }
+}
+
+static void
+test_checkpoint()
+{
+    {
+        auto ctx = std::make_shared<baryonyx::context>();
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        ctx->set_parameter("time-limit", 0.5);
+        ctx->set_parameter("thread", 2);
+        ctx->set_parameter("seed", 123654785);
+        ctx->set_parameter("checkpoint", std::string("checkpoint-test"));
+        ctx->set_parameter("checkpoint-period", 0.0);
+
+        auto result = baryonyx::optimize(ctx, pb);
+        Ensures(result.status == baryonyx::result_status::success);
+
+        Ensures(std::ifstream("checkpoint-test.0").good());
+        Ensures(std::ifstream("checkpoint-test.1").good());
+    }
+
+    std::mutex mutex;
+    std::string messages;
+    auto logger = [&mutex, &messages](baryonyx::context::message_type,
+                                      std::string message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages += message;
+    };
+
+    {
+        // The threads continue from their checkpoints.
+
+        auto ctx = std::make_shared<baryonyx::context>(logger);
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+        const auto copy = pb;
+
+        ctx->set_parameter("time-limit", 1.0);
+        ctx->set_parameter("thread", 2);
+        ctx->set_parameter("resume", std::string("checkpoint-test"));
+
+        auto result = baryonyx::optimize(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        Ensures(baryonyx::is_valid_solution(copy, result));
+        Ensures(messages.find("thread 0: resumes") != std::string::npos);
+        Ensures(messages.find("thread 1: resumes") != std::string::npos);
+    }
+
+    messages.clear();
+
+    {
+        // The checkpoints of another problem are ignored.
+
+        auto ctx = std::make_shared<baryonyx::context>(logger);
+        auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/sudoku.lp");
+
+        ctx->set_parameter("time-limit", 0.5);
+        ctx->set_parameter("thread", 1);
+        ctx->set_parameter("resume", std::string("checkpoint-test"));
+        ctx->set_parameter("checkpoint", std::string("checkpoint-other"));
+
+        baryonyx::optimize(ctx, pb);
+
+        Ensures(messages.find("different problem") != std::string::npos);
+        Ensures(messages.find("resumes") == std::string::npos);
+    }
+
+    {
+        // The time limit ends the thread before the period, the last
+        // checkpoint is written on exit.
+
+        auto ctx = std::make_shared<baryonyx::context>();
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        ctx->set_parameter("time-limit", 0.5);
+        ctx->set_parameter("thread", 1);
+        ctx->set_parameter("checkpoint", std::string("checkpoint-final"));
+        ctx->set_parameter("checkpoint-period", 3600.0);
+
+        baryonyx::optimize(ctx, pb);
+
+        Ensures(std::ifstream("checkpoint-final.0").good());
+    }
+
+    std::remove("checkpoint-test.0");
+    std::remove("checkpoint-test.1");
+    std::remove("checkpoint-other.0");
+    std::remove("checkpoint-final.0");
+}
+
 int
 main(int /* argc */, char* /* argv */ [])
 {
     auto ctx = std::make_shared<baryonyx::context>();
 
+    test_stop_and_deadline();
+    test_portfolio();
+    test_memory_limit();
+    test_thread_affinity();
+    test_checkpoint();
     test_qap(ctx);
     test_n_queens_problem(ctx);
 
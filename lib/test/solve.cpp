@@ -22,6 +22,8 @@
 
 #include "unit-test.hpp"
 
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <map>
 #include <numeric>
@@ -172,6 +174,105 @@ test_assignment_problem()
     Ensures(result.status == baryonyx::result_status::success);
 }
 
+static void
+test_preference_matrix_type()
+{
+    const char* types[] = { "float", "bfloat16" };
+
+    for (auto type : types) {
+        auto ctx = std::make_shared<baryonyx::context>();
+
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        ctx->set_parameter("limit", -1);
+        ctx->set_parameter("theta", 0.5);
+        ctx->set_parameter("delta", 0.02);
+        ctx->set_parameter("kappa-step", 0.01);
+        ctx->set_parameter("kappa-max", 60.0);
+        ctx->set_parameter("alpha", 1.0);
+        ctx->set_parameter("w", 40);
+        ctx->set_parameter("preference-matrix-type", std::string(type));
+
+        auto result = baryonyx::solve(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        Ensures(baryonyx::is_valid_solution(pb, result.variable_value) ==
+                true);
+    }
+}
+
+static void
+test_kappa_policy()
+{
+    const char* files[] = { EXAMPLES_DIR "/8_queens_puzzle.lp",
+                            EXAMPLES_DIR "/aim-50-1_6-yes1-2.lp" };
+
+    for (auto file : files) {
+        auto ctx = std::make_shared<baryonyx::context>();
+
+        auto pb = baryonyx::make_problem(ctx, file);
+
+        ctx->set_parameter("limit", -1);
+        ctx->set_parameter("theta", 0.5);
+        ctx->set_parameter("delta", 0.02);
+        ctx->set_parameter("kappa-step", 0.01);
+        ctx->set_parameter("kappa-max", 60.0);
+        ctx->set_parameter("alpha", 1.0);
+        ctx->set_parameter("w", 40);
+        ctx->set_parameter("seed", 123654785);
+        ctx->set_parameter("kappa-policy", std::string("adaptive"));
+
+        auto result = baryonyx::solve(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        Ensures(baryonyx::is_valid_solution(pb, result.variable_value) ==
+                true);
+    }
+}
+
+static void
+test_progress_callback()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+    ctx->set_parameter("limit", -1);
+    ctx->set_parameter("theta", 0.5);
+    ctx->set_parameter("delta", 0.02);
+    ctx->set_parameter("kappa-step", 0.01);
+    ctx->set_parameter("kappa-max", 60.0);
+    ctx->set_parameter("alpha", 1.0);
+    ctx->set_parameter("w", 40);
+    ctx->set_parameter("progress-period", 0.0);
+
+    int calls = 0;
+    double last_value = 0.0;
+    std::vector<int> last_x;
+
+    ctx->set_progress_callback([&](const baryonyx::progress& p) {
+        ++calls;
+        Ensures(p.thread == 0);
+        Ensures(p.x != nullptr);
+
+        if (p.remaining_constraints == 0) {
+            last_value = p.value;
+            last_x.assign(p.x, p.x + p.size);
+        }
+    });
+
+    auto result = baryonyx::solve(ctx, pb);
+
+    Ensures(calls > 0);
+    Ensures(result.status == baryonyx::result_status::success);
+
+    if (result) {
+        Ensures(last_value == result.value);
+        Ensures(last_x == result.variable_value);
+    }
+}
+
 static void
 test_assignment_problem_random_coast()
 {
@@ -368,6 +469,237 @@ test_8_queens_puzzle_random_cost()
     }
 }
 
+static void
+test_reorder()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    ctx->set_parameter("limit", -1);
+    ctx->set_parameter("theta", 0.5);
+    ctx->set_parameter("delta", 0.02);
+    ctx->set_parameter("kappa-step", 0.01);
+    ctx->set_parameter("kappa-max", 60.0);
+    ctx->set_parameter("alpha", 1.0);
+    ctx->set_parameter("w", 40);
+    ctx->set_parameter("progress-period", 0.0);
+
+    std::vector<int> last_x;
+
+    ctx->set_progress_callback([&last_x](const baryonyx::progress& p) {
+        if (p.remaining_constraints == 0)
+            last_x.assign(p.x, p.x + p.size);
+    });
+
+    for (auto reorder : { "rcm", "rcm-variables" }) {
+        ctx->set_parameter("reorder", std::string(reorder));
+
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+
+        int factor{ 1 };
+        for (auto& elem : pb.objective.elements)
+            elem.factor = (factor++ * 37) % 101;
+
+        // The solver consumes the problem, the solution is checked against a
+        // copy.
+
+        const auto copy = pb;
+        auto result = baryonyx::solve(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+
+        // The solution is restored in the problem order: the assignment of
+        // the variables by name is valid and has the value of the result.
+
+        Ensures(baryonyx::is_valid_solution(copy, result));
+        Ensures(baryonyx::compute_solution(copy, result) == result.value);
+
+        // The progress callback receives the solution in the same order.
+
+        Ensures(last_x == result.variable_value);
+    }
+}
+
+static void
+test_race()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    ctx->set_parameter("limit", -1);
+    ctx->set_parameter("theta", 0.5);
+    ctx->set_parameter("delta", 0.02);
+    ctx->set_parameter("kappa-step", 0.01);
+    ctx->set_parameter("kappa-max", 60.0);
+    ctx->set_parameter("alpha", 1.0);
+    ctx->set_parameter("w", 40);
+    ctx->set_parameter("seed", 123456);
+    ctx->set_parameter("race", 1);
+    ctx->set_parameter("thread", 4);
+
+    auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+    const auto copy = pb;
+
+    auto result = baryonyx::solve(ctx, pb);
+
+    Ensures(result.status == baryonyx::result_status::success);
+    Ensures(baryonyx::is_valid_solution(copy, result));
+    Ensures(result.method.find("race") != std::string::npos);
+
+    // The first thread keeps the seed of the solve.
+
+    if (result.method.find("thread 0/") != std::string::npos)
+        Ensures(result.seed == 123456);
+}
+
+static void
+test_decomposition()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    ctx->set_parameter("limit", -1);
+    ctx->set_parameter("seed", 123456);
+    ctx->set_parameter("decomposition", 1);
+    ctx->set_parameter("thread", 2);
+    ctx->set_parameter("progress-period", 0.0);
+
+    // The components share the progress callback: the calls are serialized
+    // and receive the solution of the whole problem.
+
+    std::atomic<int> inside{ 0 };
+    bool overlap = false;
+    std::vector<int> last_x;
+
+    ctx->set_progress_callback(
+      [&inside, &overlap, &last_x](const baryonyx::progress& p) {
+          if (++inside != 1)
+              overlap = true;
+
+          if (p.remaining_constraints == 0)
+              last_x.assign(p.x, p.x + p.size);
+
+          --inside;
+      });
+
+    // Two sub-models without shared variable.
+
+    const char* example = "minimize\n"
+                          "obj: a1 + 2a2 + 3a3 + a4 + 3b1 + 2b2 + b3 + b4\n"
+                          "st\n"
+                          "ca1: a1 + a2 + a3 = 1\n"
+                          "ca2: a2 + a3 + a4 = 1\n"
+                          "ca3: a1 + a4 + a3 >= 1\n"
+                          "cb1: b1 + b2 + b3 = 1\n"
+                          "cb2: b2 + b3 + b4 = 1\n"
+                          "cb3: b1 + b4 + b2 >= 1\n"
+                          "binary\n"
+                          "a1 a2 a3 a4 b1 b2 b3 b4\n"
+                          "end\n";
+
+    std::istringstream iss(example);
+    auto pb = baryonyx::make_problem(ctx, iss);
+    const auto copy = pb;
+
+    auto result = baryonyx::solve(ctx, pb);
+
+    Ensures(result.status == baryonyx::result_status::success);
+    Ensures(result.method.find("decomposition") != std::string::npos);
+    Ensures(baryonyx::is_valid_solution(copy, result));
+    Ensures(baryonyx::compute_solution(copy, result) == result.value);
+    Ensures(not overlap);
+    Ensures(last_x == result.variable_value);
+}
+
+static void
+test_active_set()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    ctx->set_parameter("limit", -1);
+    ctx->set_parameter("theta", 0.5);
+    ctx->set_parameter("delta", 0.02);
+    ctx->set_parameter("kappa-step", 0.01);
+    ctx->set_parameter("kappa-max", 60.0);
+    ctx->set_parameter("alpha", 1.0);
+    ctx->set_parameter("w", 40);
+    ctx->set_parameter("seed", 123456);
+    ctx->set_parameter("active-set-period", 8);
+    ctx->set_parameter("active-set-margin", 0);
+
+    for (auto order : { "none", "reversing", "random-sorting" }) {
+        ctx->set_parameter("constraint-order", std::string(order));
+
+        auto pb =
+          baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+        const auto copy = pb;
+
+        auto result = baryonyx::solve(ctx, pb);
+
+        // The lazy rows never hide a violated constraint of the result.
+
+        Ensures(result.status == baryonyx::result_status::success);
+        Ensures(baryonyx::is_valid_solution(copy, result));
+    }
+}
+
+static void
+test_init_solution()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    ctx->set_parameter("limit", -1);
+    ctx->set_parameter("theta", 0.5);
+    ctx->set_parameter("delta", 0.02);
+    ctx->set_parameter("kappa-step", 0.01);
+    ctx->set_parameter("kappa-max", 60.0);
+    ctx->set_parameter("alpha", 1.0);
+    ctx->set_parameter("w", 40);
+    ctx->set_parameter("seed", 123456);
+
+    auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/8_queens_puzzle.lp");
+    const auto copy = pb;
+
+    auto first = baryonyx::solve(ctx, pb);
+    Ensures(first.status == baryonyx::result_status::success);
+
+    {
+        std::ofstream ofs("init-solution.sol");
+
+        for (std::size_t i = 0, e = first.variable_name.size(); i != e; ++i)
+            ofs << first.variable_name[i] << '=' << first.variable_value[i]
+                << '\n';
+
+        for (std::size_t i = 0, e = first.affected_vars.names.size(); i != e;
+             ++i)
+            ofs << first.affected_vars.names[i] << '='
+                << first.affected_vars.values[i] << '\n';
+    }
+
+    // The solver starts from the feasible solution of the file: it is
+    // found before the first update of the constraints.
+
+    ctx->set_parameter("init-policy", std::string("file"));
+    ctx->set_parameter("init-solution", std::string("init-solution.sol"));
+    ctx->set_parameter("pushes-limit", 0);
+
+    auto second = copy;
+    auto result = baryonyx::solve(ctx, second);
+
+    Ensures(result.status == baryonyx::result_status::success);
+    Ensures(result.loop == 0);
+    Ensures(baryonyx::is_valid_solution(copy, result));
+
+    // A missing file falls back to the bastert policy.
+
+    ctx->set_parameter("init-solution", std::string("missing-solution.sol"));
+
+    auto third = copy;
+    result = baryonyx::solve(ctx, third);
+
+    Ensures(result.status == baryonyx::result_status::success);
+
+    std::remove("init-solution.sol");
+}
+
 static void
 test_qap()
 {
@@ -502,6 +834,133 @@ test_Z_coefficient_1()
     }
 }
 
+static void
+test_presolve()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    for (auto type : { "reduce", "probing" }) {
+        std::stringstream ss;
+
+        {
+            auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/presolve.lp");
+            ctx->set_parameter("presolve", std::string(type));
+            auto result = baryonyx::solve(ctx, pb);
+
+            Ensures(result.status == baryonyx::result_status::success);
+            Ensures(result.variable_name.size() +
+                      result.affected_vars.names.size() ==
+                    8);
+
+            ss << result;
+            Ensures(ss.good());
+        }
+
+        {
+            auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/presolve.lp");
+            auto re = baryonyx::make_result(ctx, ss);
+
+            Ensures(baryonyx::is_valid_solution(pb, re));
+        }
+    }
+
+    ctx->set_parameter("time-limit", 1.0);
+    ctx->set_parameter("thread", 1);
+
+    auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/presolve.lp");
+    auto result = baryonyx::optimize(ctx, pb);
+
+    Ensures(result.status == baryonyx::result_status::success);
+    Ensures(result.value == -1.0);
+}
+
+static void
+test_general_variables()
+{
+    auto ctx = std::make_shared<baryonyx::context>();
+
+    auto pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/general-2.lp");
+
+    ctx->set_parameter("seed", 104);
+    ctx->set_parameter("limit", -1);
+    ctx->set_parameter("theta", 0.5);
+    ctx->set_parameter("delta", 0.01);
+    ctx->set_parameter("kappa-step", 0.01);
+    ctx->set_parameter("kappa-max", 60.0);
+    ctx->set_parameter("alpha", 1.0);
+    ctx->set_parameter("w", 20);
+
+    auto result = baryonyx::solve(ctx, pb);
+
+    Ensures(result.status == baryonyx::result_status::success);
+
+    if (result) {
+        pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/general-2.lp");
+
+        Ensures(result.variable_name.size() == 4);
+        Ensures(result.variables == 4);
+        Ensures(baryonyx::is_valid_solution(pb, result) == true);
+        Ensures(baryonyx::compute_solution(pb, result) == result.value);
+    }
+
+    {
+        // Negative lower bounds and units of several variables in a row
+        // with 1 and -1 coefficients.
+
+        const char* example = "minimize\n"
+                              "x + 2 y - z\n"
+                              "st\n"
+                              "c1: x + y + z >= 4\n"
+                              "c2: x - z <= 1\n"
+                              "bounds\n"
+                              "x >= -2\n"
+                              "x <= 3\n"
+                              "y <= 4\n"
+                              "z >= -1\n"
+                              "z <= 2\n"
+                              "general\n"
+                              "x y z\n"
+                              "end\n";
+
+        std::istringstream iss(example);
+        auto pb = baryonyx::make_problem(ctx, iss);
+        const auto copy = pb;
+
+        auto result = baryonyx::solve(ctx, pb);
+
+        Ensures(result.status == baryonyx::result_status::success);
+        Ensures(result.variables == 3);
+        Ensures(baryonyx::is_valid_solution(copy, result) == true);
+        Ensures(baryonyx::compute_solution(copy, result) == result.value);
+    }
+
+    ctx->set_parameter("time-limit", 1.0);
+    ctx->set_parameter("thread", 1);
+    pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/general-2.lp");
+    result = baryonyx::optimize(ctx, pb);
+
+    Ensures(result.status == baryonyx::result_status::success);
+
+    if (result) {
+        pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/general-2.lp");
+
+        Ensures(baryonyx::is_valid_solution(pb, result) == true);
+        Ensures(result.value == 11.0);
+    }
+
+    ctx->set_parameter("integer-domain-limit", 2);
+    pb = baryonyx::make_problem(ctx, EXAMPLES_DIR "/general-2.lp");
+
+    bool failure = false;
+    try {
+        baryonyx::solve(ctx, pb);
+    } catch (const baryonyx::solver_failure&) {
+        failure = true;
+    }
+
+    Ensures(failure == true);
+}
+
 #if 0
 static void
 test_bibd1n()
@@ -539,6 +998,11 @@ main(int /*argc*/, char* /* argv */ [])
     test_preprocessor_2();
     test_real_cost();
     test_assignment_problem();
+    test_preference_matrix_type();
+    test_kappa_policy();
+    test_progress_callback();
+    test_general_variables();
+    test_presolve();
     test_assignment_problem_random_coast();
     test_negative_coeff();
     test_negative_coeff2();
@@ -547,6 +1011,11 @@ main(int /*argc*/, char* /* argv */ [])
     test_negative_coeff5();
     test_8_queens_puzzle_fixed_cost();
     test_8_queens_puzzle_random_cost();
+    test_reorder();
+    test_race();
+    test_decomposition();
+    test_active_set();
+    test_init_solution();
     test_qap();
     test_uf50_0448();
     test_flat30_7();
@@ -448,3 +448,106 @@ optimize_01lp_problem(std::string file_path,
 
     return ret;
 }
+
+//' Optimizes the 01 linear programming problem and returns the trajectory of
+//' the solutions found.
+//'
+//' The parameters are the same as the \code{optimize_01lp_problem}
+//' function. The \code{progress_period} parameter bounds the number of
+//' reports (in seconds) for each thread.
+//'
+//' @return a data frame with one row for each reported improvement:
+//'   - value: the value of the objective function.
+//'   - duration: the time in seconds since the thread starts.
+//'   - thread: the identifier of the thread.
+//'   - remaining: the number of remaining constraints (0 for a solution).
+//'
+//' @useDynLib rbaryonyx
+//' @importFrom Rcpp sourceCpp
+//'
+//' @export
+// [[Rcpp::export]]
+DataFrame
+optimize_01lp_problem_trajectory(std::string file_path,
+                                 int limit = 1000,
+                                 double theta = 0.5,
+                                 double delta = 1e-4,
+                                 int constraint_order = 0,
+                                 double kappa_min = 0.1,
+                                 double kappa_step = 1e-4,
+                                 double kappa_max = 1.0,
+                                 double alpha = 1.0,
+                                 int w = 500,
+                                 double time_limit = 10.0,
+                                 int seed = -1,
+                                 int thread = 1,
+                                 int norm = 4,
+                                 double pushing_k_factor = 0.9,
+                                 double pushing_objective_amplifier = 5.0,
+                                 int pushes_limit = 10,
+                                 int pushing_iteration_limit = 20,
+                                 int policy_type = 0,
+                                 double policy_random = 0.5,
+                                 int float_type = 1,
+                                 double progress_period = 0.1,
+                                 bool verbose = true) noexcept
+{
+    // The callback is called from the optimizer threads, the R API can not
+    // be used here, progress are stored and converted after the
+    // optimization.
+
+    std::vector<double> values, durations;
+    std::vector<int> threads, remainings;
+
+    try {
+        auto ctx = std::make_shared<baryonyx::context>(r_write);
+        ctx->set_log_priority(verbose
+                                ? baryonyx::context::message_type::info
+                                : baryonyx::context::message_type::warning);
+
+        auto pb = baryonyx::make_problem(ctx, file_path);
+
+        assign_parameters(ctx,
+                          limit,
+                          theta,
+                          delta,
+                          constraint_order,
+                          kappa_min,
+                          kappa_step,
+                          kappa_max,
+                          alpha,
+                          w,
+                          time_limit,
+                          seed,
+                          thread,
+                          norm,
+                          pushing_k_factor,
+                          pushing_objective_amplifier,
+                          pushes_limit,
+                          pushing_iteration_limit,
+                          policy_type,
+                          policy_random,
+                          float_type);
+
+        ctx->set_parameter("progress-period", progress_period);
+        ctx->set_progress_callback([&](const baryonyx::progress& p) {
+            values.emplace_back(p.value);
+            durations.emplace_back(p.duration);
+            threads.emplace_back(p.thread);
+            remainings.emplace_back(p.remaining_constraints);
+        });
+
+        baryonyx::optimize(ctx, pb);
+    } catch (const std::bad_alloc& e) {
+        Rprintf("lp memory error: %s\n", e.what());
+    } catch (const std::exception& e) {
+        Rprintf("lp error: %s\n", e.what());
+    } catch (...) {
+        Rprintf("lp error: unknown error\n");
+    }
+
+    return DataFrame::create(Named("value") = values,
+                             Named("duration") = durations,
+                             Named("thread") = threads,
+                             Named("remaining") = remainings);
+}